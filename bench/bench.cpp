@@ -0,0 +1,406 @@
+//
+// Created by Ryan Senoune on 2025-03-12.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include "generator.h"
+#include "../parser/parser.h"
+#include "../semantic/name_analysis.h"
+#include "../semantic/type_analysis.h"
+#include "../ir/instruction_gen.h"
+#include "../ir/reg_alloc.h"
+#include "../ir/frame_layout.h"
+#include "../ir/pass_manager.h"
+#include "../ir/inliner.h"
+#include "../x86/code_gen.h"
+#include "../driver/std_library.h"
+#include "../driver/version.h"
+
+/*
+ * Compiler throughput benchmark
+ *
+ *   bench [-json] [-o file] [-scale N] [-seed S] [-repeat R] [-O N] [-workload=name] [-write=dir] [-std-path=dir]
+ *
+ * Every workload is a generated program stressing one part of the compiler. It goes through
+ * the same phases as a compile, single threaded and in memory, and each phase reports its
+ * rate in the unit it consumes: tokens for the lexer, AST nodes for the parser and semantic
+ * analysis, IR instructions for the backend. The best of the repeats is kept.
+ */
+
+struct Workload {
+    std::string name;
+    GeneratorConfig config;
+};
+
+struct Phase {
+    std::string name;
+    std::string unit;
+    double seconds = 0;
+    long count = 0;
+};
+
+struct Result {
+    std::string name;
+    long lines = 0;
+    long bytes = 0;
+    std::vector<Phase> phases;
+    double total = 0;
+};
+
+// counts statements, expressions and declarations, types are part of their node
+class NodeCounter : public Visitor<void> {
+public:
+    long nodes = 0;
+
+    void visit(std::shared_ptr<Program> p) override {
+        for (auto& d : p->decls){
+            d->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<FuncDecl> f) override {
+        nodes++;
+        for (auto& a : f->args){
+            a->accept(*this);
+        }
+        f->block->accept(*this);
+    }
+    void visit(std::shared_ptr<FunProto> f) override {
+        nodes++;
+        for (auto& a : f->args){
+            a->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<StructDecl> s) override {
+        nodes++;
+        for (auto& v : s->varDecls){
+            v->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<Block> b) override {
+        nodes++;
+        for (auto& s : b->stmts){
+            s->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<Return> r) override {
+        nodes++;
+        if (r->expr.has_value()){
+            r->expr.value()->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<If> i) override {
+        nodes++;
+        i->expr1->accept(*this);
+        i->stmt1->accept(*this);
+        if (i->stmt2.has_value()){
+            i->stmt2.value()->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<While> w) override {
+        nodes++;
+        w->expr->accept(*this);
+        w->stmt->accept(*this);
+    }
+    void visit(std::shared_ptr<Break>) override { nodes++; }
+    void visit(std::shared_ptr<Continue>) override { nodes++; }
+    void visit(std::shared_ptr<VarDecl>) override { nodes++; }
+    void visit(std::shared_ptr<Subscript> s) override {
+        nodes++;
+        s->array->accept(*this);
+        s->index->accept(*this);
+    }
+    void visit(std::shared_ptr<Member> m) override {
+        nodes++;
+        m->structure->accept(*this);
+    }
+    void visit(std::shared_ptr<Call> c) override {
+        nodes++;
+        for (auto& a : c->args){
+            a->accept(*this);
+        }
+    }
+    void visit(std::shared_ptr<Primary>) override { nodes++; }
+    void visit(std::shared_ptr<Unary> u) override {
+        nodes++;
+        u->expr1->accept(*this);
+    }
+    void visit(std::shared_ptr<TypeCast> t) override {
+        nodes++;
+        t->expr1->accept(*this);
+    }
+    void visit(std::shared_ptr<Binary> b) override {
+        nodes++;
+        b->expr1->accept(*this);
+        b->expr2->accept(*this);
+    }
+    void visit(std::shared_ptr<Type>) override {}
+};
+
+static double seconds(const std::function<void()>& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Result run(const Workload& w, const std::string& source, StdLibrary& std_library, PassManager& passes, int budget, int repeat) {
+    Result result;
+    result.name = w.name;
+    result.bytes = source.size();
+    result.lines = std::count(source.begin(), source.end(), '\n');
+    result.phases = {{"lex", "tokens"}, {"parse", "nodes"}, {"name_analysis", "nodes"}, {"type_analysis", "nodes"},
+                     {"instruction_gen", "instructions"}, {"passes", "instructions"}, {"reg_alloc", "instructions"},
+                     {"code_gen", "instructions"}};
+
+    for (int r = 0; r < repeat; r++){
+        std::vector<double> times(result.phases.size());
+
+        long tokens = 0;
+        times[0] = seconds([&] {
+            Lexer lexer(source);
+            while (lexer.nextToken()->token_type != TT::END_OF_FILE){
+                tokens++;
+            }
+        });
+
+        Lexer lexer(source);
+        Parser parser(lexer, std_library);
+        parser.tokenize();
+        std::shared_ptr<Program> program;
+        times[1] = seconds([&] { program = parser.program(); });
+        program->addStandardLibrary();
+
+        NodeCounter counter;
+        program->accept(counter);
+
+        NameAnalysis n;
+        times[2] = seconds([&] { program->accept(n); });
+        TypeAnalysis t;
+        times[3] = seconds([&] { program->accept(t); });
+
+        // inlining decisions are made on the AST, their time counts towards instruction_gen
+        std::unique_ptr<Inliner> inliner;
+        if (budget > 0){
+            times[4] += seconds([&] { inliner = std::make_unique<Inliner>(program, budget); });
+        }
+
+        long instructions = 0;
+        for (auto& d : program->decls){
+            auto f = std::dynamic_pointer_cast<FuncDecl>(d);
+            if (!f || f->name == "emit_asm"){
+                continue;
+            }
+
+            InstructionGen i;
+            i.inliner = inliner.get();
+            times[4] += seconds([&] { f->accept(i); });
+            instructions += i.instructions.size();
+
+            times[5] += seconds([&] { passes.run(i.instructions, f->name); });
+
+            RegAlloc regs;
+            std::unordered_map<std::string, std::string> reg_alloc;
+            times[6] += seconds([&] {
+                reg_alloc = regs.naive_reg_alloc(i.instructions);
+                FrameLayout(false).run(i.instructions);
+            });
+
+            std::ostringstream assembly;
+            times[7] += seconds([&] {
+                CodeGen c(assembly, std::move(i.instructions), std::move(reg_alloc));
+                c.generate_text();
+            });
+        }
+
+        std::vector<long> counts = {tokens, counter.nodes, counter.nodes, counter.nodes, instructions, instructions, instructions, instructions};
+        for (size_t p = 0; p < result.phases.size(); p++){
+            Phase& phase = result.phases[p];
+            phase.count = counts[p];
+            if (r == 0 || times[p] < phase.seconds){
+                phase.seconds = times[p];
+            }
+        }
+    }
+
+    for (auto& p : result.phases){
+        result.total += p.seconds;
+    }
+    return result;
+}
+
+static double rate(double count, double seconds) {
+    return seconds > 0 ? count / seconds : 0;
+}
+
+static std::string json(const std::vector<Result>& results, uint64_t seed, int scale, int level) {
+    std::ostringstream out;
+    out << "{\n  \"compiler_version\": \"" << COMPILER_VERSION << "\",\n  \"seed\": " << seed << ",\n  \"scale\": " << scale << ",\n";
+    out << "  \"opt_level\": " << level << ",\n";
+    out << "  \"workloads\": [\n";
+    for (size_t i = 0; i < results.size(); i++){
+        const Result& r = results[i];
+        out << "    {\n      \"name\": \"" << r.name << "\",\n      \"lines\": " << r.lines << ",\n      \"bytes\": " << r.bytes << ",\n";
+        out << "      \"seconds\": " << r.total << ",\n      \"lines_per_second\": " << rate(r.lines, r.total) << ",\n";
+        out << "      \"phases\": {\n";
+        for (size_t p = 0; p < r.phases.size(); p++){
+            const Phase& phase = r.phases[p];
+            out << "        \"" << phase.name << "\": {\"seconds\": " << phase.seconds << ", \"" << phase.unit << "\": " << phase.count
+                << ", \"" << phase.unit << "_per_second\": " << rate(phase.count, phase.seconds) << ", \"lines_per_second\": "
+                << rate(r.lines, phase.seconds) << "}" << (p + 1 < r.phases.size() ? "," : "") << "\n";
+        }
+        out << "      }\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+static std::string table(const std::vector<Result>& results) {
+    std::ostringstream out;
+    char line[160];
+    for (auto& r : results){
+        snprintf(line, sizeof(line), "%s: %ld lines, %.3f ms, %.0f lines/s\n", r.name.c_str(), r.lines, r.total * 1000, rate(r.lines, r.total));
+        out << line;
+        for (auto& p : r.phases){
+            snprintf(line, sizeof(line), "  %-16s %10.3f ms %10ld %-12s %14.0f /s %12.0f lines/s\n", p.name.c_str(), p.seconds * 1000,
+                     p.count, p.unit.c_str(), rate(p.count, p.seconds), rate(r.lines, p.seconds));
+            out << line;
+        }
+    }
+    return out.str();
+}
+
+static std::vector<Workload> workloads(int scale) {
+    std::vector<Workload> w(6);
+
+    w[0].name = "functions";
+    w[0].config.functions = 1000 * scale;
+    w[0].config.statements = 4;
+    w[0].config.expression_depth = 2;
+
+    w[1].name = "expressions";
+    w[1].config.functions = 50 * scale;
+    w[1].config.statements = 12;
+    w[1].config.expression_depth = 14;
+
+    w[2].name = "structs";
+    w[2].config.functions = 200 * scale;
+    w[2].config.structs = 32;
+    w[2].config.struct_fields = 96;
+
+    w[3].name = "calls";
+    w[3].config.functions = 10;
+    w[3].config.call_chain = 2000 * scale;
+
+    w[4].name = "print";
+    w[4].config.functions = 200 * scale;
+    w[4].config.prints = 32;
+
+    w[5].name = "mixed";
+    w[5].config.functions = 400 * scale;
+    w[5].config.statements = 10;
+    w[5].config.expression_depth = 6;
+    w[5].config.structs = 8;
+    w[5].config.struct_fields = 24;
+    w[5].config.call_chain = 200 * scale;
+    w[5].config.prints = 6;
+
+    return w;
+}
+
+int main(int argc, char *argv[]) {
+    bool as_json = false;
+    std::string output, only, write_dir;
+    std::vector<std::string> std_path;
+    int scale = 1, repeat = 3, level = 0;
+    uint64_t seed = 1;
+
+    try{
+        for (int i = 1; i < argc; i++){
+            std::string arg = argv[i];
+            auto value = [&](const std::string& flag) {
+                if (i + 1 >= argc){
+                    throw std::invalid_argument("Expected a value after " + flag);
+                }
+                return std::string(argv[++i]);
+            };
+
+            if (arg == "-json"){
+                as_json = true;
+            }
+            else if (arg == "-o"){
+                output = value(arg);
+            }
+            else if (arg == "-scale"){
+                scale = std::max(1, std::stoi(value(arg)));
+            }
+            else if (arg == "-seed"){
+                seed = std::stoull(value(arg));
+            }
+            else if (arg == "-O"){
+                level = std::stoi(value(arg));
+            }
+            else if (arg == "-repeat"){
+                repeat = std::max(1, std::stoi(value(arg)));
+            }
+            else if (arg.rfind("-workload=", 0) == 0){
+                only = arg.substr(std::string("-workload=").size());
+            }
+            else if (arg.rfind("-write=", 0) == 0){
+                write_dir = arg.substr(std::string("-write=").size());
+            }
+            else if (arg.rfind("-std-path=", 0) == 0){
+                std_path.push_back(arg.substr(std::string("-std-path=").size()));
+            }
+            else{
+                throw std::invalid_argument("Unknown option '" + arg + "'");
+            }
+        }
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (std_path.empty()){
+        std_path.push_back("../std");
+    }
+    StdLibrary std_library(std_path);
+    PassManager passes(PassManager::preset(level));
+
+    std::vector<Result> results;
+    for (auto& w : workloads(scale)){
+        if (!only.empty() && w.name != only){
+            continue;
+        }
+
+        GeneratorConfig config = w.config;
+        config.seed = seed;
+        std::string source = ProgramGenerator(config).generate();
+
+        // the generated sources can be fed to the compiler itself, e.g. with -time-report
+        if (!write_dir.empty()){
+            std::ofstream(write_dir + "/" + w.name + ".c") << source;
+        }
+
+        try{
+            results.push_back(run(w, source, std_library, passes, Inliner::preset(level), repeat));
+        }
+        catch(const std::exception& e) {
+            std::cerr << w.name << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::string report = as_json ? json(results, seed, scale, level) : table(results);
+    if (output.empty()){
+        std::cout << report;
+    }
+    else{
+        std::ofstream(output) << report;
+    }
+    return 0;
+}
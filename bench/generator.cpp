@@ -0,0 +1,177 @@
+//
+// Created by Ryan Senoune on 2025-03-12.
+//
+
+#include "generator.h"
+
+uint64_t ProgramGenerator::next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+int ProgramGenerator::below(int n) {
+    return n <= 0 ? 0 : int(next() % uint64_t(n));
+}
+
+std::string ProgramGenerator::generate() {
+    out = "#include <print>\n\n";
+    structs();
+    chain();
+    for (int k = 0; k < config.functions; k++){
+        function(k);
+    }
+    entry();
+    return std::move(out);
+}
+
+/*
+ * Field m of every struct is an int when m % 3 == 0, a char when m % 3 == 1
+ * and an int[4] otherwise, so expressions know which fields they can read
+ */
+void ProgramGenerator::structs() {
+    for (int s = 0; s < config.structs; s++){
+        out += "struct S" + std::to_string(s) + " {\n";
+        for (int m = 0; m < config.struct_fields; m++){
+            std::string field = "f" + std::to_string(m);
+            switch (m % 3){
+                case 0: out += "    int " + field + ";\n"; break;
+                case 1: out += "    char " + field + ";\n"; break;
+                default: out += "    int " + field + "[4];\n"; break;
+            }
+        }
+        out += "};\n\n";
+    }
+}
+
+void ProgramGenerator::chain() {
+    out += "int chain0(int x){\n    return x;\n}\n\n";
+    for (int n = 1; n < config.call_chain; n++){
+        out += "int chain" + std::to_string(n) + "(int x){\n";
+        out += "    return chain" + std::to_string(n - 1) + "(x + " + std::to_string(n) + ") * 2 - x;\n}\n\n";
+    }
+}
+
+std::string ProgramGenerator::leaf(int locals, int fields) {
+    switch (below(6)){
+        case 0: return "a";
+        case 1: return "b";
+        case 2: return std::to_string(below(1000));
+        case 3: {
+            if (fields > 0){
+                int m = below(fields);
+                if (m % 3 == 0){
+                    return "(*s).f" + std::to_string(m);
+                }
+                if (m % 3 == 2){
+                    return "(*s).f" + std::to_string(m) + "[" + std::to_string(below(4)) + "]";
+                }
+            }
+            return "arr[" + std::to_string(below(8)) + "]";
+        }
+        default: return "v" + std::to_string(below(locals));
+    }
+}
+
+std::string ProgramGenerator::expr(int depth, int locals, int fields) {
+    if (depth <= 0){
+        return leaf(locals, fields);
+    }
+
+    static const char* ops[] = {" + ", " - ", " * ", " + ", " - ", " < ", " == ", " && "};
+    std::string lhs = expr(depth - 1, locals, fields);
+    // mostly left leaning so the size stays linear in the depth, with some bushy subtrees
+    std::string rhs = below(4) == 0 ? expr(depth - 2, locals, fields) : leaf(locals, fields);
+    std::string op = ops[below(8)];
+    if (below(8) == 0){
+        op = " / ";
+        rhs = std::to_string(1 + below(9));
+    }
+    return "(" + lhs + op + rhs + ")";
+}
+
+void ProgramGenerator::function(int k) {
+    int locals = 2 + config.statements / 2;
+    int s = config.structs > 0 ? k % config.structs : -1;
+    int fields = s >= 0 ? config.struct_fields : 0;
+
+    out += "int fn" + std::to_string(k) + "(int a, int b";
+    if (s >= 0){
+        out += ", struct S" + std::to_string(s) + "* s";
+    }
+    out += "){\n";
+    for (int v = 0; v < locals; v++){
+        out += "    int v" + std::to_string(v) + ";\n";
+    }
+    out += "    int arr[8];\n";
+    out += "    v0 = a + b;\n";
+    for (int v = 1; v < locals; v++){
+        out += "    v" + std::to_string(v) + " = " + expr(1, v, 0) + ";\n";
+    }
+
+    for (int i = 0; i < config.statements; i++){
+        std::string v = "v" + std::to_string(below(locals));
+        switch (below(6)){
+            case 0:
+                out += "    if (" + expr(config.expression_depth / 2, locals, fields) + "){\n";
+                out += "        " + v + " = " + expr(config.expression_depth, locals, fields) + ";\n";
+                out += "    }\n    else{\n";
+                out += "        " + v + " = " + expr(config.expression_depth, locals, fields) + ";\n    }\n";
+                break;
+            case 1:
+                out += "    while (" + v + " < " + std::to_string(below(100)) + "){\n";
+                out += "        " + v + " = " + v + " + 1;\n";
+                out += "        arr[" + std::to_string(below(8)) + "] = " + expr(config.expression_depth / 2, locals, fields) + ";\n    }\n";
+                break;
+            case 2:
+                if (fields > 0){
+                    int m = 3 * below((fields + 2) / 3);
+                    out += "    (*s).f" + std::to_string(m) + " = " + expr(config.expression_depth, locals, fields) + ";\n";
+                    break;
+                }
+            // without a struct parameter this is a plain assignment
+            default:
+                out += "    " + v + " = " + expr(config.expression_depth, locals, fields) + ";\n";
+                break;
+        }
+    }
+
+    for (int p = 0; p < config.prints; p++){
+        if (p % 2 == 0){
+            out += "    print_i(" + expr(config.expression_depth / 2, locals, fields) + ");\n";
+        }
+        else{
+            out += "    print_c('" + std::string(1, char('a' + below(26))) + "');\n";
+        }
+    }
+
+    // call an earlier function taking the same struct type, so long programs get deep call graphs
+    if (s < 0 && k > 0){
+        out += "    v0 = v0 + fn" + std::to_string(below(k)) + "(v1, " + expr(2, locals, fields) + ");\n";
+    }
+    else if (s >= 0 && k >= config.structs){
+        int callee = s + config.structs * below((k - s) / config.structs);
+        out += "    v0 = v0 + fn" + std::to_string(callee) + "(v1, " + expr(2, locals, fields) + ", s);\n";
+    }
+    out += "    return " + expr(config.expression_depth, locals, fields) + ";\n}\n\n";
+}
+
+void ProgramGenerator::entry() {
+    out += "int main(){\n";
+    for (int s = 0; s < config.structs; s++){
+        out += "    struct S" + std::to_string(s) + " s" + std::to_string(s) + ";\n";
+    }
+    out += "    int r;\n    r = 0;\n";
+    for (int k = 0; k < config.functions; k += 1 + config.functions / 16){
+        out += "    r = r + fn" + std::to_string(k) + "(" + std::to_string(k) + ", r";
+        if (config.structs > 0){
+            out += ", &s" + std::to_string(k % config.structs);
+        }
+        out += ");\n";
+    }
+    if (config.call_chain > 0){
+        out += "    r = r + chain" + std::to_string(config.call_chain - 1) + "(r);\n";
+    }
+    out += "    print_i(r);\n    return 0;\n}\n";
+}
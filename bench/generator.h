@@ -0,0 +1,55 @@
+//
+// Created by Ryan Senoune on 2025-03-12.
+//
+
+#ifndef COMPILER_GENERATOR_H
+#define COMPILER_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+// shape of a generated program, every knob scales one kind of compiler work
+struct GeneratorConfig {
+    uint64_t seed = 1;
+    int functions = 100;
+    int statements = 8;
+    // nesting of the generated expressions
+    int expression_depth = 4;
+    int structs = 4;
+    int struct_fields = 12;
+    // chain<n> calls chain<n-1> ... down to chain0
+    int call_chain = 20;
+    // print_i and print_c calls per function
+    int prints = 2;
+};
+
+/*
+ * Deterministic source generator for benchmarks
+ * The same config gives the same program on every platform (own PRNG, no std distributions).
+ * Output is valid input for this compiler: it only uses int, char, structs, arrays and
+ * pointers, and calls the print module. It is meant to be compiled, not run.
+ */
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(GeneratorConfig config) : config(config), state(config.seed) {}
+
+    std::string generate();
+
+private:
+    GeneratorConfig config;
+    uint64_t state;
+    std::string out;
+
+    // splitmix64
+    uint64_t next();
+    int below(int n);
+
+    void structs();
+    void chain();
+    void function(int k);
+    void entry();
+    std::string expr(int depth, int locals, int fields);
+    std::string leaf(int locals, int fields);
+};
+
+#endif //COMPILER_GENERATOR_H
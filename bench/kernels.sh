@@ -0,0 +1,79 @@
+#!/bin/bash
+
+# Runtime benchmark: compiles every kernel in kernels/ with each compiler flag set and with
+# gcc -O0/-O2 as a reference, checks they all print the same thing and times them with measure
+#
+#   ./kernels.sh [kernel.c...]
+#
+# BUILD is the directory holding compiler and measure, RUNS the runs per binary (fastest is kept),
+# LEVELS the compiler flag sets to compare, separated by commas (-O0,-O1,-O2 by default)
+
+cd "$(dirname "$0")"
+BUILD=$(cd "${BUILD:-../cmake-build-debug}" && pwd)
+RUNS=${RUNS:-5}
+CC=${CC:-gcc}
+IFS=',' read -r -a LEVELS <<< "${LEVELS--O0,-O1,-O2}"
+if [ ${#LEVELS[@]} -eq 0 ]; then
+    LEVELS=("")
+fi
+
+# the compiler emits x86-64 macOS code, Apple silicon runs it under Rosetta
+RUN=""
+if [ "$(uname -m)" = "arm64" ]; then
+    RUN="arch -x86_64"
+fi
+
+kernels=("$@")
+if [ ${#kernels[@]} -eq 0 ]; then
+    kernels=(kernels/*.c)
+fi
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+printf "%-14s %-18s %10s %14s %14s %8s\n" "kernel" "build" "seconds" "cycles" "instructions" "vs -O2"
+
+for kernel in "${kernels[@]}"; do
+    name=$(basename "$kernel" .c)
+    builds=()
+
+    for opt in -O0 -O2; do
+        if $CC $opt -w -I kernels/gcc -x c "$kernel" -o "$work/gcc$opt"; then
+            builds+=("gcc$opt")
+        fi
+    done
+    expected=$("$work/gcc-O2")
+
+    for level in "${LEVELS[@]}"; do
+        build="cc$level"
+        if ! (cd "$work" && "$BUILD/compiler" "$OLDPWD/$kernel" $level -std-path="$OLDPWD/../std") ||
+           ! nasm -f macho64 "$work/output.asm" -o "$work/output.o" ||
+           ! ld -o "$work/$build" "$work/output.o" -macosx_version_min 10.7 -no_pie; then
+            echo "$name: $build failed to build"
+            continue
+        fi
+
+        actual=$($RUN "$work/$build")
+        if [ "$actual" != "$expected" ]; then
+            echo "$name: $build printed '$actual', gcc printed '$expected'"
+            continue
+        fi
+        builds+=("$build")
+    done
+
+    results=()
+    reference=""
+    for build in "${builds[@]}"; do
+        run=""
+        [[ $build == cc* ]] && run=$RUN
+        result=$("$BUILD/measure" -runs "$RUNS" $run "$work/$build") || result="- - -"
+        results+=("$result")
+        [ "$build" = gcc-O2 ] && reference=${result%% *}
+    done
+
+    for i in "${!builds[@]}"; do
+        read -r seconds cycles instructions <<< "${results[$i]}"
+        ratio=$(awk -v s="$seconds" -v r="$reference" 'BEGIN { if (s + 0 > 0 && r + 0 > 0) printf "%.2fx", s / r; else print "-" }')
+        printf "%-14s %-18s %10s %14s %14s %8s\n" "$name" "${builds[$i]}" "$seconds" "$cycles" "$instructions" "$ratio"
+    done
+done
@@ -0,0 +1,16 @@
+#include <print>
+
+int fibonacci(int n){
+    if (n == 0){
+        return 0;
+    }
+    if (n == 1){
+        return 1;
+    }
+    return fibonacci(n-1) + fibonacci(n-2);
+}
+
+int main(){
+    print_i(fibonacci(30));
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include <print>
+
+struct Node {
+    int value;
+    struct Node* next;
+};
+
+int main(){
+    struct Node nodes[50000];
+    struct Node* n;
+    int i;
+    int j;
+    int steps;
+    int sum;
+
+    // link the nodes into one cycle in a scattered order so every step is a dependent load
+    i = 0;
+    while (i < 50000){
+        j = (i * 7919) % 50000;
+        nodes[j].value = i;
+        nodes[j].next = &nodes[((i + 1) * 7919) % 50000];
+        i = i + 1;
+    }
+
+    sum = 0;
+    steps = 0;
+    n = &nodes[0];
+    while (steps < 5000000){
+        sum = (sum + (*n).value) % 1000003;
+        n = (*n).next;
+        steps = steps + 1;
+    }
+    print_i(sum);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <print>
+
+int main(){
+    int a[96][96];
+    int b[96][96];
+    int c[96][96];
+    int i;
+    int j;
+    int k;
+    int sum;
+
+    i = 0;
+    while (i < 96){
+        j = 0;
+        while (j < 96){
+            a[i][j] = (i + j) % 7;
+            b[i][j] = (i * j) % 5;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+
+    i = 0;
+    while (i < 96){
+        j = 0;
+        while (j < 96){
+            sum = 0;
+            k = 0;
+            while (k < 96){
+                sum = sum + a[i][k] * b[k][j];
+                k = k + 1;
+            }
+            c[i][j] = sum;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+
+    sum = 0;
+    i = 0;
+    while (i < 96){
+        sum = (sum + c[i][i] * (i + 1)) % 1000003;
+        i = i + 1;
+    }
+    print_i(sum);
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <print>
+
+// number of primes below n, flags must hold n ints
+int sieve(int* flags, int n){
+    int i;
+    int j;
+    int count;
+    i = 0;
+    while (i < n){
+        flags[i] = 1;
+        i = i + 1;
+    }
+    count = 0;
+    i = 2;
+    while (i < n){
+        if (flags[i]){
+            count = count + 1;
+            j = i + i;
+            while (j < n){
+                flags[j] = 0;
+                j = j + i;
+            }
+        }
+        i = i + 1;
+    }
+    return count;
+}
+
+int main(){
+    int flags[200000];
+    int round;
+    int count;
+    round = 0;
+    while (round < 20){
+        count = sieve(&flags[0], 200000);
+        round = round + 1;
+    }
+    print_i(count);
+    return 0;
+}
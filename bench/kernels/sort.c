@@ -0,0 +1,57 @@
+#include <print>
+
+// shell sort with the 3x+1 gaps
+void sort(int* a, int n){
+    int gap;
+    int i;
+    int j;
+    int v;
+    gap = 1;
+    while (gap < n / 3){
+        gap = gap * 3 + 1;
+    }
+    while (gap > 0){
+        i = gap;
+        while (i < n){
+            v = a[i];
+            j = i;
+            while (j >= gap && a[j - gap] > v){
+                a[j] = a[j - gap];
+                j = j - gap;
+            }
+            a[j] = v;
+            i = i + 1;
+        }
+        gap = gap / 3;
+    }
+}
+
+int main(){
+    int a[100000];
+    int i;
+    int x;
+    int sorted;
+
+    x = 1;
+    i = 0;
+    while (i < 100000){
+        x = (x * 75 + 74) % 65537;
+        a[i] = x;
+        i = i + 1;
+    }
+
+    sort(&a[0], 100000);
+
+    sorted = 1;
+    i = 1;
+    while (i < 100000){
+        if (a[i - 1] > a[i]){
+            sorted = 0;
+        }
+        i = i + 1;
+    }
+    print_i(sorted);
+    print_c(' ');
+    print_i(a[50000]);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <print>
+
+struct Particle {
+    int x;
+    int y;
+    int dx;
+    int dy;
+    char alive;
+};
+
+int main(){
+    struct Particle p[1000];
+    int i;
+    int step;
+    int alive;
+    int checksum;
+
+    i = 0;
+    while (i < 1000){
+        p[i].x = i % 100;
+        p[i].y = i / 100;
+        p[i].dx = i % 3 - 1;
+        p[i].dy = i % 5 - 2;
+        p[i].alive = 'y';
+        i = i + 1;
+    }
+
+    step = 0;
+    while (step < 2000){
+        i = 0;
+        while (i < 1000){
+            if (p[i].alive == 'y'){
+                p[i].x = p[i].x + p[i].dx;
+                p[i].y = p[i].y + p[i].dy;
+                if (p[i].x < -10000 || p[i].x > 10000){
+                    p[i].alive = 'n';
+                }
+            }
+            i = i + 1;
+        }
+        step = step + 1;
+    }
+
+    alive = 0;
+    checksum = 0;
+    i = 0;
+    while (i < 1000){
+        if (p[i].alive == 'y'){
+            alive = alive + 1;
+        }
+        checksum = (checksum + p[i].x * 3 + p[i].y) % 1000003;
+        i = i + 1;
+    }
+    print_i(alive);
+    print_c(' ');
+    print_i(checksum);
+    return 0;
+}
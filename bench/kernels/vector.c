@@ -0,0 +1,47 @@
+#include <print>
+
+// c = a * k + b over n ints
+void axpy(int* a, int* b, int* c, int n, int k){
+    int i;
+    i = 0;
+    while (i < n){
+        c[i] = a[i] * k + b[i];
+        i = i + 1;
+    }
+}
+
+int sum(int* a, int n){
+    int s;
+    int i;
+    s = 0;
+    i = 0;
+    while (i < n){
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+int main(){
+    int a[4096];
+    int b[4096];
+    int c[4096];
+    int i;
+    int round;
+    int check;
+    i = 0;
+    while (i < 4096){
+        a[i] = i;
+        b[i] = 4096 - i;
+        i = i + 1;
+    }
+    check = 0;
+    round = 0;
+    while (round < 3000){
+        axpy(&a[0], &b[0], &c[0], 4096, round % 7);
+        check = (check + sum(&c[0], 4096)) % 1000003;
+        round = round + 1;
+    }
+    print_i(check);
+    return 0;
+}
@@ -0,0 +1,142 @@
+//
+// Created by Ryan Senoune on 2025-03-13.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/*
+ * Runs a program and prints "<seconds> <cycles> <instructions>" for its fastest run
+ *
+ *   measure [-runs N] <program> [args...]
+ *
+ * Cycles and instructions are user space counts from perf_event_open, they print as "-" where
+ * it is not available (not Linux, or perf_event_paranoid forbids it). The program's stdout is
+ * discarded, a nonzero exit status is reported and fails the measurement.
+ */
+
+struct Sample {
+    double seconds = 0;
+    long long cycles = -1;
+    long long instructions = -1;
+};
+
+#ifdef __linux__
+static int open_counter(pid_t pid, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0));
+}
+
+static long long read_counter(int fd) {
+    long long value = -1;
+    if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)){
+        return -1;
+    }
+    return value;
+}
+#endif
+
+// the child waits on a pipe until its counters are attached, so they only see the exec'd program
+static bool run(char** argv, Sample& sample) {
+    int go[2];
+    if (pipe(go) != 0){
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0){
+        close(go[1]);
+        char byte;
+        if (read(go[0], &byte, 1) != 1){
+            _exit(127);
+        }
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    close(go[0]);
+
+    int cycles = -1, instructions = -1;
+#ifdef __linux__
+    cycles = open_counter(pid, PERF_COUNT_HW_CPU_CYCLES);
+    instructions = open_counter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+#endif
+
+    auto start = std::chrono::steady_clock::now();
+    char byte = 0;
+    (void) write(go[1], &byte, 1);
+    close(go[1]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+#ifdef __linux__
+    sample.cycles = read_counter(cycles);
+    sample.instructions = read_counter(instructions);
+#endif
+    if (cycles >= 0){
+        close(cycles);
+    }
+    if (instructions >= 0){
+        close(instructions);
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+        fprintf(stderr, "%s exited with status %d\n", argv[0], WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return false;
+    }
+    return true;
+}
+
+static std::string count(long long value) {
+    return value < 0 ? "-" : std::to_string(value);
+}
+
+int main(int argc, char *argv[]) {
+    int runs = 5;
+    int i = 1;
+    if (i + 1 < argc && std::string(argv[i]) == "-runs"){
+        runs = std::max(1, atoi(argv[i + 1]));
+        i += 2;
+    }
+    if (i >= argc){
+        fprintf(stderr, "measure [-runs N] <program> [args...]\n");
+        return 1;
+    }
+
+    Sample best;
+    for (int r = 0; r < runs; r++){
+        Sample sample;
+        if (!run(argv + i, sample)){
+            return 1;
+        }
+        if (r == 0 || sample.seconds < best.seconds){
+            best = sample;
+        }
+    }
+
+    printf("%.6f %s %s\n", best.seconds, count(best.cycles).c_str(), count(best.instructions).c_str());
+    return 0;
+}
@@ -0,0 +1,313 @@
+//
+// Created by Ryan Senoune on 2025-03-02.
+//
+
+#include "compilation.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "../parser/parser.h"
+#include "../semantic/name_analysis.h"
+#include "../semantic/type_analysis.h"
+#include "../semantic/fingerprint.h"
+#include "../semantic/fused_analysis.h"
+#include "../ir/instruction_gen.h"
+#include "../ir/reg_alloc.h"
+#include "../ir/frame_layout.h"
+#include "../ir/ir_printer.h"
+#include "../x86/code_gen.h"
+#include "../util/hash.h"
+#include "version.h"
+
+std::string Compilation::asm_file() const {
+    return output_stem.empty() ? "output.asm" : output_stem + ".asm";
+}
+
+std::string Compilation::dump_file(const std::string& stage) const {
+    return options.dump_ir_dir + "/" + (output_stem.empty() ? "output" : output_stem) + "." + stage + ".ir";
+}
+
+bool IRDump::wants(const std::string& stage, const std::string& f) const {
+    if (!function.empty() && function != f){
+        return false;
+    }
+    return std::find(stages.begin(), stages.end(), stage) != stages.end() || std::find(stages.begin(), stages.end(), "all") != stages.end();
+}
+
+bool Compilation::run() {
+    TimeProfiler::Scope compile(profiler, "Compile", input);
+
+    std::string content;
+    {
+        TimeProfiler::Scope scope(profiler, "Read", input);
+        std::ifstream file(input);
+
+        if (!file){
+            diagnostics = "Source code file not found";
+            return false;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+    }
+
+    try{
+        std::string key;
+        if (cache){
+            TimeProfiler::Scope scope(profiler, "CacheLookup", input);
+            key = cache_key(content);
+            if (options.dump_ir.empty() && cache->fetch(key, asm_file())){
+                return true;
+            }
+        }
+
+        Lexer lexer(content);
+        Parser parser(lexer, std_library);
+        // the parser pulls tokens as it goes, lexing is split out only when it is being timed
+        if (profiler){
+            TimeProfiler::Scope scope(profiler, "Lex", input);
+            parser.tokenize();
+        }
+
+        std::shared_ptr<Program> program;
+        {
+            TimeProfiler::Scope scope(profiler, "Parse", input);
+            program = parser.program();
+        }
+
+        {
+            TimeProfiler::Scope scope(profiler, "StdLibrary", input);
+            program->addStandardLibrary();
+        }
+
+        // decided on the AST, the fingerprints depend on what gets inlined
+        int budget = options.inline_budget >= 0 ? options.inline_budget : Inliner::preset(options.opt_level);
+        if (budget > 0){
+            TimeProfiler::Scope scope(profiler, "Inliner", input);
+            inliner = std::make_unique<Inliner>(program, budget);
+        }
+
+        if (function_cache){
+            TimeProfiler::Scope scope(profiler, "Fingerprint", input);
+            fetch_functions(program);
+        }
+
+        if (options.fused_analysis){
+            TimeProfiler::Scope scope(profiler, "FusedAnalysis", input);
+            FusedAnalysis f;
+            program->accept(f);
+        }
+        else{
+            {
+                TimeProfiler::Scope scope(profiler, "NameAnalysis", input);
+                NameAnalysis n;
+                program->accept(n);
+            }
+            {
+                TimeProfiler::Scope scope(profiler, "TypeAnalysis", input);
+                TypeAnalysis t;
+                program->accept(t);
+            }
+        }
+
+        generate_functions(program, parser.includes);
+
+        // only a compile that went through is worth remembering
+        if (function_cache){
+            for (auto& [f, fingerprint] : fingerprints){
+                if (!f->unchanged){
+                    function_cache->store(fingerprint, outputs[f]);
+                }
+            }
+        }
+
+        if (cache){
+            cache->store(key, asm_file());
+        }
+    }
+    catch(const std::exception& e) {
+        diagnostics = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * The only preprocessing is #include, so the preprocessed source is the source plus the
+ * hashes of the std modules it includes
+ */
+std::string Compilation::cache_key(const std::string& content) {
+    Hash key;
+    key.add(COMPILER_VERSION).add(options.codegen_flags()).add(content);
+
+    Lexer lexer(content);
+    for (auto t = lexer.nextToken(); t->token_type == TT::INCLUDE; t = lexer.nextToken()){
+        std::shared_ptr<const StdModule> module = std_library.load(t->value);
+        key.add(t->value).add(module ? module->hash : 0);
+    }
+
+    return key.hex();
+}
+
+/*
+ * Functions whose fingerprint is cached are marked unchanged before semantic analysis,
+ * which then only checks their signature, and their IR and assembly are reused
+ */
+void Compilation::fetch_functions(std::shared_ptr<Program> program) {
+    Fingerprint fingerprint(program, inliner.get());
+
+    for (auto d : program->decls){
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(d); f && f->name != "emit_asm"){
+            std::string key = Hash().add(options.codegen_flags()).add(fingerprint.of(f)).hex();
+            fingerprints[f] = key;
+
+            // a dump needs the IR, which is not cached, so every function is regenerated.
+            // An inlined function is too, its body has to be analysed to be generated in its callers
+            FunctionOutput output;
+            if (options.dump_ir.empty() && !(inliner && inliner->inlined(f)) && function_cache->fetch(key, output)){
+                f->unchanged = true;
+                outputs[f] = std::move(output);
+            }
+        }
+    }
+}
+
+/*
+ * Once semantic analysis is done functions are independent, each one goes through
+ * IR generation, register allocation and code generation as its own task.
+ * Outputs are concatenated in declaration order so the assembly is deterministic
+ */
+void Compilation::generate_functions(std::shared_ptr<Program> program, const std::vector<std::shared_ptr<const StdModule>>& includes) {
+    std::vector<std::shared_ptr<FuncDecl>> funcs;
+    for (auto d : program->decls){
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(d); f && f->name != "emit_asm"){
+            funcs.push_back(f);
+        }
+    }
+
+    std::vector<FunctionOutput> generated(funcs.size());
+    std::vector<std::exception_ptr> errors(funcs.size());
+    IRDump dump{options.dump_ir, options.dump_ir_func};
+
+    {
+        // elapsed time of the parallel part, the function phases below it are summed over workers
+        TimeProfiler::Scope scope(profiler, "Generate", input);
+        TaskGroup group;
+        for (int k = 0; k < funcs.size(); k++){
+            if (funcs[k]->unchanged){
+                continue;
+            }
+            pool.submit(group, [&, k] {
+                try{
+                    generated[k] = generate_function(program, funcs[k], passes, inliner.get(), options.omit_frame_pointer, profiler, dump.stages.empty() ? nullptr : &dump);
+                }
+                catch(...) {
+                    errors[k] = std::current_exception();
+                }
+            });
+        }
+        pool.wait(group);
+    }
+
+    for (auto& e : errors){
+        if (e){
+            std::rethrow_exception(e);
+        }
+    }
+
+    functions = funcs.size();
+    for (int k = 0; k < funcs.size(); k++){
+        if (!funcs[k]->unchanged){
+            outputs[funcs[k]] = std::move(generated[k]);
+            regenerated++;
+        }
+    }
+
+    TimeProfiler::Scope scope(profiler, "Emit", input);
+    std::ofstream assembly(asm_file());
+
+    CodeGen(assembly, {}, {}).generate_header();
+    for (auto& m : includes){
+        assembly << m->assembly;
+    }
+    for (auto& f : funcs){
+        assembly << outputs[f].assembly;
+    }
+    CodeGen(assembly, {}, {}).generate_entry();
+
+    if (!options.dump_ir.empty()){
+        write_dumps(funcs);
+    }
+}
+
+// one file per stage with the functions in declaration order, each written in a single call
+void Compilation::write_dumps(const std::vector<std::shared_ptr<FuncDecl>>& funcs) {
+    std::vector<std::pair<std::string, std::string>> stages;
+    for (auto& f : funcs){
+        for (auto& [stage, ir] : outputs[f].dumps){
+            auto it = std::find_if(stages.begin(), stages.end(), [&](auto& s) { return s.first == stage; });
+            if (it == stages.end()){
+                it = stages.insert(stages.end(), {stage, ""});
+            }
+            it->second += ir;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.dump_ir_dir, error);
+    for (auto& [stage, ir] : stages){
+        std::ofstream file(dump_file(stage), std::ios::binary);
+        file.write(ir.data(), ir.size());
+    }
+}
+
+FunctionOutput Compilation::generate_function(std::shared_ptr<Program> program, std::shared_ptr<FuncDecl> f, PassManager* passes,
+                                              const Inliner* inliner, bool omit_frame_pointer, TimeProfiler* profiler, const IRDump* dump) {
+    FunctionOutput output;
+    InstructionGen i;
+    i.inliner = inliner;
+
+    // the IR is only printed when a dump asks for this stage of this function
+    auto snapshot = [&](const std::string& stage) {
+        if (dump && dump->wants(stage, f->name)){
+            output.dumps.emplace_back(stage, IRPrinter::str(i.instructions));
+        }
+    };
+
+    {
+        TimeProfiler::Scope scope(profiler, "InstructionGen", f->name);
+        // top level variables get a register in every function that could reference them
+        for (auto d : program->decls){
+            if (auto v = std::dynamic_pointer_cast<VarDecl>(d)){
+                v->accept(i);
+            }
+        }
+        f->accept(i);
+    }
+    snapshot("gen");
+
+    if (passes){
+        passes->run(i.instructions, f->name, profiler, snapshot);
+    }
+    snapshot("opt");
+
+    std::unordered_map<std::string, std::string> reg_alloc;
+    {
+        TimeProfiler::Scope scope(profiler, "RegAlloc", f->name);
+        RegAlloc r;
+        reg_alloc = r.naive_reg_alloc(i.instructions);
+        FrameLayout(omit_frame_pointer).run(i.instructions);
+    }
+    snapshot("alloc");
+
+    TimeProfiler::Scope scope(profiler, "CodeGen", f->name);
+    std::ostringstream assembly;
+    CodeGen c(assembly, std::move(i.instructions), std::move(reg_alloc));
+    c.generate_text();
+    output.assembly = assembly.str();
+
+    return output;
+}
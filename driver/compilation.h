@@ -0,0 +1,76 @@
+//
+// Created by Ryan Senoune on 2025-03-02.
+//
+
+#ifndef COMPILER_COMPILATION_H
+#define COMPILER_COMPILATION_H
+
+#include <string>
+#include "options.h"
+#include "../parser/ast.h"
+#include "../util/thread_pool.h"
+#include "../util/time_profiler.h"
+#include "../ir/pass_manager.h"
+#include "../ir/inliner.h"
+#include "std_library.h"
+#include "compile_cache.h"
+#include "function_cache.h"
+
+// which IR snapshots generate_function keeps, from -dump-ir and -dump-ir-func
+struct IRDump {
+    std::vector<std::string> stages;
+    std::string function;
+
+    bool wants(const std::string& stage, const std::string& f) const;
+};
+
+/*
+ * One translation unit going through the whole pipeline
+ * Everything a compile mutates lives in here or in the phase objects it creates,
+ * so independent compilations can run on different threads
+ */
+class Compilation {
+public:
+    std::string input;
+    std::string output_stem;
+    const Options& options;
+    ThreadPool& pool;
+    StdLibrary& std_library;
+    CompileCache* cache;
+    // null unless -watch or -cache-dir, then unchanged functions are reused
+    FunctionCache* function_cache;
+    PassManager* passes;
+    // null unless -time-report or -time-trace
+    TimeProfiler* profiler;
+
+    std::string diagnostics;
+    int functions = 0;
+    int regenerated = 0;
+
+    Compilation(std::string input, std::string output_stem, const Options& options, ThreadPool& pool, StdLibrary& std_library, CompileCache* cache, FunctionCache* function_cache, PassManager* passes, TimeProfiler* profiler) :
+            input(std::move(input)), output_stem(std::move(output_stem)), options(options), pool(pool), std_library(std_library), cache(cache), function_cache(function_cache), passes(passes), profiler(profiler) {}
+
+    // returns false if the compile failed, the error is left in diagnostics
+    bool run();
+
+    std::string asm_file() const;
+    std::string dump_file(const std::string& stage) const;
+
+    // without a pass manager the IR goes to register allocation as generated, without an inliner every call stays a call
+    static FunctionOutput generate_function(std::shared_ptr<Program> program, std::shared_ptr<FuncDecl> f, PassManager* passes = nullptr,
+                                            const Inliner* inliner = nullptr, bool omit_frame_pointer = false,
+                                            TimeProfiler* profiler = nullptr, const IRDump* dump = nullptr);
+
+private:
+    std::unordered_map<std::shared_ptr<FuncDecl>, std::string> fingerprints;
+    std::unordered_map<std::shared_ptr<FuncDecl>, FunctionOutput> outputs;
+    // null when the inline budget is 0
+    std::unique_ptr<Inliner> inliner;
+
+    std::string cache_key(const std::string& content);
+    void fetch_functions(std::shared_ptr<Program> program);
+    void generate_functions(std::shared_ptr<Program> program, const std::vector<std::shared_ptr<const StdModule>>& includes);
+    void write_dumps(const std::vector<std::shared_ptr<FuncDecl>>& funcs);
+};
+
+#endif //COMPILER_COMPILATION_H
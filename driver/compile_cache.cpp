@@ -0,0 +1,60 @@
+//
+// Created by Ryan Senoune on 2025-03-06.
+//
+
+#include "compile_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+std::string CompileCache::entry(const std::string& key) const {
+    return dir + "/" + key + ".asm";
+}
+
+bool CompileCache::fetch(const std::string& key, const std::string& output) {
+    std::ifstream in(entry(key), std::ios::binary);
+    if (!in){
+        misses++;
+        return false;
+    }
+
+    std::ofstream out(output, std::ios::binary);
+    out << in.rdbuf();
+    if (!out){
+        misses++;
+        return false;
+    }
+
+    hits++;
+    bytes_saved += uint64_t(out.tellp());
+    return true;
+}
+
+void CompileCache::store(const std::string& key, const std::string& output) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+
+    // write then rename, so concurrent builds sharing the directory never read a partial entry
+    std::ostringstream id;
+    id << std::this_thread::get_id() << "-" << std::random_device()();
+    std::string tmp = entry(key) + ".tmp" + id.str();
+    {
+        std::ifstream in(output, std::ios::binary);
+        std::ofstream out(tmp, std::ios::binary);
+        if (!in || !out){
+            return;
+        }
+        out << in.rdbuf();
+    }
+    std::filesystem::rename(tmp, entry(key), error);
+    if (error){
+        std::filesystem::remove(tmp, error);
+    }
+}
+
+std::string CompileCache::stats() const {
+    return "cache: " + std::to_string(hits) + " hits, " + std::to_string(misses) + " misses, "
+           + std::to_string(bytes_saved) + " bytes saved";
+}
@@ -0,0 +1,37 @@
+//
+// Created by Ryan Senoune on 2025-03-06.
+//
+
+#ifndef COMPILER_COMPILE_CACHE_H
+#define COMPILER_COMPILE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * Opt in on-disk cache of generated assembly (-cache-dir=<dir>)
+ * Entries are named by a key hashing the source, the hashes of its std includes,
+ * the compiler version and the codegen flags, so an entry never has to be invalidated
+ */
+class CompileCache {
+public:
+    explicit CompileCache(std::string dir) : dir(std::move(dir)) {}
+
+    // copies the cached output for key to output, false on a miss
+    bool fetch(const std::string& key, const std::string& output);
+    void store(const std::string& key, const std::string& output);
+
+    std::atomic<int> hits{0};
+    std::atomic<int> misses{0};
+    std::atomic<uint64_t> bytes_saved{0};
+
+    std::string stats() const;
+
+private:
+    std::string dir;
+
+    std::string entry(const std::string& key) const;
+};
+
+#endif //COMPILER_COMPILE_CACHE_H
@@ -0,0 +1,98 @@
+//
+// Created by Ryan Senoune on 2025-03-08.
+//
+
+#include "function_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "version.h"
+
+std::string FunctionCache::entry(const std::string& fingerprint) const {
+    return dir + "/" + fingerprint + ".fn";
+}
+
+bool FunctionCache::fetch(const std::string& fingerprint, FunctionOutput& output) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto it = functions.find(fingerprint); it != functions.end()){
+            output = it->second;
+            hits++;
+            return true;
+        }
+    }
+
+    if (dir.empty() || !read_entry(fingerprint, output)){
+        misses++;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    functions[fingerprint] = output;
+    hits++;
+    return true;
+}
+
+void FunctionCache::store(const std::string& fingerprint, const FunctionOutput& output) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        functions[fingerprint] = output;
+    }
+
+    if (!dir.empty()){
+        write_entry(fingerprint, output);
+    }
+}
+
+/*
+ * Entry layout, same sections as a std module artifact:
+ *     ; function <compiler version> <fingerprint>
+ *     ; assembly <size>
+ */
+bool FunctionCache::read_entry(const std::string& fingerprint, FunctionOutput& output) {
+    std::ifstream file(entry(fingerprint), std::ios::binary);
+    if (!file){
+        return false;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    if (line != std::string("; function ") + COMPILER_VERSION + " " + fingerprint){
+        return false;
+    }
+
+    std::string tag;
+    size_t size;
+    std::getline(file, line);
+    std::istringstream sizes(line);
+    if (!(sizes >> tag >> tag >> size) || tag != "assembly"){
+        return false;
+    }
+
+    output.assembly.resize(size);
+    return !size || file.read(&output.assembly[0], size);
+}
+
+void FunctionCache::write_entry(const std::string& fingerprint, const FunctionOutput& output) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+
+    // write then rename, so concurrent builds sharing the directory never read a partial entry
+    std::ostringstream id;
+    id << std::this_thread::get_id() << "-" << std::random_device()();
+    std::string tmp = entry(fingerprint) + ".tmp" + id.str();
+    {
+        std::ofstream file(tmp, std::ios::binary);
+        if (!file){
+            return;
+        }
+        file << "; function " << COMPILER_VERSION << " " << fingerprint << "\n";
+        file << "; assembly " << output.assembly.size() << "\n" << output.assembly << "\n";
+    }
+    std::filesystem::rename(tmp, entry(fingerprint), error);
+    if (error){
+        std::filesystem::remove(tmp, error);
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by Ryan Senoune on 2025-03-08.
+//
+
+#ifndef COMPILER_FUNCTION_CACHE_H
+#define COMPILER_FUNCTION_CACHE_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// assembly of a single function, produced independently of the others
+struct FunctionOutput {
+    std::string assembly;
+    // (stage, IR) snapshots asked for with -dump-ir, never cached
+    std::vector<std::pair<std::string, std::string>> dumps;
+};
+
+/*
+ * Generated functions keyed by their fingerprint (semantic/fingerprint.h)
+ * Kept in memory for the lifetime of the process, which is what keeps -watch hot,
+ * and mirrored to <dir>/<fingerprint>.fn when a cache directory is given
+ */
+class FunctionCache {
+public:
+    explicit FunctionCache(std::string dir) : dir(std::move(dir)) {}
+
+    bool fetch(const std::string& fingerprint, FunctionOutput& output);
+    void store(const std::string& fingerprint, const FunctionOutput& output);
+
+    std::atomic<int> hits{0};
+    std::atomic<int> misses{0};
+
+private:
+    std::string dir;
+    std::mutex mutex;
+    std::unordered_map<std::string, FunctionOutput> functions;
+
+    std::string entry(const std::string& fingerprint) const;
+    bool read_entry(const std::string& fingerprint, FunctionOutput& output);
+    void write_entry(const std::string& fingerprint, const FunctionOutput& output);
+};
+
+#endif //COMPILER_FUNCTION_CACHE_H
@@ -0,0 +1,153 @@
+//
+// Created by Ryan Senoune on 2025-03-02.
+//
+
+#include "options.h"
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+static void split(const std::string& list, std::vector<std::string>& out) {
+    std::stringstream items(list);
+    for (std::string item; std::getline(items, item, ',');){
+        if (!item.empty()){
+            out.push_back(item);
+        }
+    }
+}
+
+static int parse_budget(const std::string& value) {
+    try{
+        size_t end;
+        int budget = std::stoi(value, &end);
+        if (end == value.size() && budget >= 0){
+            return budget;
+        }
+    }
+    catch(const std::exception&) {}
+
+    throw std::invalid_argument("Invalid inline budget '" + value + "'");
+}
+
+static int parse_jobs(const std::string& value) {
+    try{
+        size_t end;
+        int jobs = std::stoi(value, &end);
+        if (jobs == 0){
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if (end == value.size() && jobs > 0){
+            return jobs;
+        }
+    }
+    catch(const std::exception&) {}
+
+    throw std::invalid_argument("Invalid job count '" + value + "'");
+}
+
+Options parse_options(int argc, char *argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+
+        if (arg == "-lexer"){
+            options.print_lexer = true;
+        }
+        else if (arg == "-ast"){
+            options.print_ast = true;
+        }
+        else if (arg == "-j"){
+            if (i + 1 >= argc){
+                throw std::invalid_argument("Expected a job count after -j");
+            }
+            options.jobs = parse_jobs(argv[++i]);
+        }
+        else if (arg.rfind("-std-path=", 0) == 0){
+            options.std_path.push_back(arg.substr(std::string("-std-path=").size()));
+        }
+        else if (arg.rfind("-cache-dir=", 0) == 0){
+            options.cache_dir = arg.substr(std::string("-cache-dir=").size());
+        }
+        else if (arg == "-cache-stats"){
+            options.cache_stats = true;
+        }
+        else if (arg == "-watch"){
+            options.watch = true;
+        }
+        else if (arg == "-fused-analysis"){
+            options.fused_analysis = true;
+        }
+        else if (arg == "-time-report"){
+            options.time_report = true;
+        }
+        else if (arg == "-time-trace"){
+            options.time_trace = "trace.json";
+        }
+        else if (arg.rfind("-time-trace=", 0) == 0){
+            options.time_trace = arg.substr(std::string("-time-trace=").size());
+        }
+        else if (arg == "-O0" || arg == "-O1" || arg == "-O2"){
+            options.opt_level = arg[2] - '0';
+        }
+        else if (arg.rfind("-passes=", 0) == 0){
+            options.custom_passes = true;
+            options.passes.clear();
+            split(arg.substr(std::string("-passes=").size()), options.passes);
+        }
+        else if (arg.rfind("-inline-budget=", 0) == 0){
+            options.inline_budget = parse_budget(arg.substr(std::string("-inline-budget=").size()));
+        }
+        else if (arg == "-fomit-frame-pointer"){
+            options.omit_frame_pointer = true;
+        }
+        else if (arg.rfind("-march=", 0) == 0){
+            options.target = Target::parse(arg.substr(std::string("-march=").size()));
+        }
+        else if (arg.rfind("-dump-ir=", 0) == 0){
+            split(arg.substr(std::string("-dump-ir=").size()), options.dump_ir);
+        }
+        else if (arg.rfind("-dump-ir-dir=", 0) == 0){
+            options.dump_ir_dir = arg.substr(std::string("-dump-ir-dir=").size());
+        }
+        else if (arg.rfind("-dump-ir-func=", 0) == 0){
+            options.dump_ir_func = arg.substr(std::string("-dump-ir-func=").size());
+        }
+        else if (arg.rfind("-j", 0) == 0){
+            options.jobs = parse_jobs(arg.substr(2));
+        }
+        else if (arg.size() > 1 && arg[0] == '-'){
+            throw std::invalid_argument("Unknown option '" + arg + "'");
+        }
+        else{
+            options.inputs.push_back(arg);
+        }
+    }
+
+    if (options.std_path.empty()){
+        options.std_path.push_back("../std");
+    }
+
+    return options;
+}
+
+// the -O level also picks the inline budget, so it is always part of the flags
+std::string Options::codegen_flags() const {
+    std::string flags = "-O" + std::to_string(opt_level);
+    if (custom_passes){
+        flags += " -passes=";
+        for (size_t i = 0; i < passes.size(); i++){
+            flags += (i ? "," : "") + passes[i];
+        }
+    }
+    if (inline_budget >= 0){
+        flags += " -inline-budget=" + std::to_string(inline_budget);
+    }
+    if (omit_frame_pointer){
+        flags += " -fomit-frame-pointer";
+    }
+    if (target.march != Target().march){
+        flags += " -march=" + target.march;
+    }
+    return flags;
+}
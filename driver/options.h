@@ -0,0 +1,53 @@
+//
+// Created by Ryan Senoune on 2025-03-02.
+//
+
+#ifndef COMPILER_OPTIONS_H
+#define COMPILER_OPTIONS_H
+
+#include <string>
+#include <vector>
+#include "../ir/target.h"
+
+struct Options {
+    std::vector<std::string> inputs;
+    bool print_lexer = false;
+    bool print_ast = false;
+    int jobs = 1;
+    // directories searched for #include <name>, ../std when none is given
+    std::vector<std::string> std_path;
+    // empty when the compile cache is off
+    std::string cache_dir;
+    bool cache_stats = false;
+    // keep running and recompile inputs when they change
+    bool watch = false;
+    // name and type analysis in one walk
+    bool fused_analysis = false;
+    // print per-phase timings after every compile
+    bool time_report = false;
+    // empty unless -time-trace, then the Chrome trace is written there
+    std::string time_trace;
+    // -O level, the pass pipeline unless -passes= names one
+    int opt_level = 0;
+    bool custom_passes = false;
+    std::vector<std::string> passes;
+    // estimated instructions a callee may have to be inlined, the -O level's budget when negative
+    int inline_budget = -1;
+    // address the frame from rsp and leave rbp alone
+    bool omit_frame_pointer = false;
+    // -march=, which vector instructions the vectorizer may use
+    Target target;
+    // IR stages to write (gen, a pass name, opt, alloc or all), nothing is written when empty
+    std::vector<std::string> dump_ir;
+    std::string dump_ir_dir = ".";
+    // only dump this function when set
+    std::string dump_ir_func;
+
+    // the flags that change generated code, part of every cache key
+    std::string codegen_flags() const;
+};
+
+// throws std::invalid_argument on unknown or malformed flags
+Options parse_options(int argc, char *argv[]);
+
+#endif //COMPILER_OPTIONS_H
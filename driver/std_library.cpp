@@ -0,0 +1,139 @@
+//
+// Created by Ryan Senoune on 2025-03-04.
+//
+
+#include "std_library.h"
+#include <fstream>
+#include <sstream>
+#include "compilation.h"
+#include "version.h"
+#include "../parser/parser.h"
+#include "../semantic/name_analysis.h"
+#include "../semantic/type_analysis.h"
+#include "../util/hash.h"
+
+std::shared_ptr<const StdModule> StdLibrary::load(const std::string& name) {
+    for (auto& dir : search_path){
+        std::ifstream file(dir + "/" + name + ".c");
+        if (!file){
+            continue;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string source = buffer.str();
+        uint64_t hash = Hash().add(COMPILER_VERSION).add(source).value;
+
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        std::string key = name + "@" + Hash{hash}.hex();
+        if (auto it = modules.find(key); it != modules.end()){
+            return it->second;
+        }
+
+        std::string artifact = dir + "/" + name + ".pre";
+        std::shared_ptr<StdModule> module = read_artifact(artifact, name, hash);
+        if (!module){
+            module = build(name, source, hash);
+            write_artifact(artifact, *module);
+        }
+
+        modules[key] = module;
+        return module;
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<StdModule> StdLibrary::build(const std::string& name, const std::string& source, uint64_t hash) {
+    TimeProfiler::Scope scope(profiler, "StdModule", name);
+    auto module = std::make_shared<StdModule>();
+    module->name = name;
+    module->hash = hash;
+
+    Lexer lexer(source);
+    Parser parser(lexer, *this);
+    std::shared_ptr<Program> program = parser.program();
+
+    // nested modules stay includes so they are not declared twice
+    for (auto& m : parser.includes){
+        module->header += "#include <" + m->name + ">\n";
+    }
+    // a module prototype always has its definition in the module
+    for (size_t i = parser.included_decls; i < program->decls.size(); i++){
+        if (!std::dynamic_pointer_cast<FunProto>(program->decls[i])){
+            module->header += declaration(program->decls[i]);
+        }
+    }
+
+    program->addStandardLibrary();
+
+    NameAnalysis n;
+    program->accept(n);
+
+    TypeAnalysis t;
+    program->accept(t);
+
+    for (size_t i = parser.included_decls; i < program->decls.size(); i++){
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(program->decls[i]); f && f->name != "emit_asm"){
+            module->assembly += Compilation::generate_function(program, f, nullptr, nullptr, false, profiler).assembly;
+        }
+    }
+
+    return module;
+}
+
+/*
+ * Artifact layout, sizes in bytes so the sections can hold anything:
+ *     ; std module <name> <compiler version> <hash>
+ *     ; header <size>
+ *     <header>
+ *     ; assembly <size>
+ *     <assembly>
+ */
+std::shared_ptr<StdModule> StdLibrary::read_artifact(const std::string& path, const std::string& name, uint64_t hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file){
+        return nullptr;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    if (line != "; std module " + name + " " + COMPILER_VERSION + " " + Hash{hash}.hex()){
+        return nullptr;
+    }
+
+    auto module = std::make_shared<StdModule>();
+    module->name = name;
+    module->hash = hash;
+
+    for (std::string* section : {&module->header, &module->assembly}){
+        std::string tag;
+        size_t size;
+        std::getline(file, line);
+        std::istringstream sizes(line);
+        if (!(sizes >> tag >> tag >> size)){
+            return nullptr;
+        }
+
+        section->resize(size);
+        if (!file.read(&(*section)[0], size)){
+            return nullptr;
+        }
+        file.ignore(1); // newline after the section
+    }
+
+    return module;
+}
+
+void StdLibrary::write_artifact(const std::string& path, const StdModule& module) {
+    // a read only std directory only costs a rebuild per run
+    std::ofstream file(path, std::ios::binary);
+    if (!file){
+        return;
+    }
+
+    file << "; std module " << module.name << " " << COMPILER_VERSION << " " << Hash{module.hash}.hex() << "\n";
+    file << "; header " << module.header.size() << "\n" << module.header << "\n";
+    file << "; assembly " << module.assembly.size() << "\n" << module.assembly << "\n";
+}
@@ -0,0 +1,41 @@
+//
+// Created by Ryan Senoune on 2025-03-04.
+//
+
+#ifndef COMPILER_STD_LIBRARY_H
+#define COMPILER_STD_LIBRARY_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../parser/ast.h"
+#include "../parser/module.h"
+#include "../util/time_profiler.h"
+
+/*
+ * Resolves #include <name> to std/<name>.c and hands out the precompiled module
+ *
+ * A module is compiled once into its declarations and assembly, keyed by the hash of its source
+ * and the compiler version. It is kept in memory for the other translation units of the run
+ * and written next to the source as <name>.pre, so later runs only read that file back.
+ */
+class StdLibrary : public ModuleLoader {
+public:
+    explicit StdLibrary(std::vector<std::string> search_path, TimeProfiler* profiler = nullptr) :
+            search_path(std::move(search_path)), profiler(profiler) {}
+
+    std::shared_ptr<const StdModule> load(const std::string& name) override;
+
+private:
+    std::vector<std::string> search_path;
+    TimeProfiler* profiler;
+    // recursive since building a module parses it, which may include other modules
+    std::recursive_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const StdModule>> modules;
+
+    std::shared_ptr<StdModule> build(const std::string& name, const std::string& source, uint64_t hash);
+    std::shared_ptr<StdModule> read_artifact(const std::string& path, const std::string& name, uint64_t hash);
+    void write_artifact(const std::string& path, const StdModule& module);
+};
+
+#endif //COMPILER_STD_LIBRARY_H
@@ -0,0 +1,11 @@
+//
+// Created by Ryan Senoune on 2025-03-04.
+//
+
+#ifndef COMPILER_VERSION_H
+#define COMPILER_VERSION_H
+
+// bump whenever generated code changes, it invalidates precompiled and cached outputs
+#define COMPILER_VERSION "0.8.5"
+
+#endif //COMPILER_VERSION_H
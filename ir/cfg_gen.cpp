@@ -3,3 +3,160 @@
 //
 
 #include "cfg_gen.h"
+#include <algorithm>
+
+std::string CFG::trimmed(const std::string& opcode) {
+    return opcode.substr(0, opcode.find_last_not_of(' ') + 1);
+}
+
+// a jump to a local label, empty for calls, returns and jumps leaving the function
+static std::string local_target(const std::shared_ptr<BranchInstruction>& branch) {
+    if (!branch->registers.empty() || branch->label.empty() || branch->label[0] != '.'){
+        return "";
+    }
+    return branch->label;
+}
+
+CFG CFG::build(const std::vector<std::shared_ptr<Instruction>>& instructions, std::string name) {
+    CFG cfg(name);
+    cfg.block_of.assign(instructions.size(), -1);
+    std::unordered_map<std::string, int> labels;
+
+    std::shared_ptr<BasicBlock> current;
+    for (size_t k = 0; k < instructions.size(); k++){
+        auto label = std::dynamic_pointer_cast<Label>(instructions[k]);
+        if (!current || (label && current->begin != k)){
+            if (current){
+                current->end = k;
+            }
+            current = cfg.new_block();
+            current->begin = k;
+        }
+        if (label){
+            labels[label->label] = current->id;
+        }
+        current->instructions.push_back(instructions[k]);
+        cfg.block_of[k] = current->id;
+
+        auto branch = std::dynamic_pointer_cast<BranchInstruction>(instructions[k]);
+        if (branch && branch->opcode.rfind("call", 0) != 0){
+            current->end = k + 1;
+            current = nullptr;
+        }
+    }
+    if (current){
+        current->end = instructions.size();
+    }
+
+    for (auto& block : cfg.blocks){
+        auto branch = std::dynamic_pointer_cast<BranchInstruction>(instructions[block->end - 1]);
+        bool falls_through = true;
+        if (branch && branch->opcode.rfind("call", 0) != 0){
+            std::string opcode = trimmed(branch->opcode);
+            std::string target = local_target(branch);
+            auto it = labels.find(target);
+            if (it != labels.end()){
+                block->successors.push_back(it->second);
+            }
+            falls_through = opcode != "jmp" && opcode != "ret";
+        }
+        if (falls_through && block->id + 1 < cfg.block_count
+            && std::find(block->successors.begin(), block->successors.end(), block->id + 1) == block->successors.end()){
+            block->successors.push_back(block->id + 1);
+        }
+        for (int s : block->successors){
+            cfg.blocks[s]->predecessors.push_back(block->id);
+        }
+    }
+
+    if (!cfg.blocks.empty()){
+        cfg.entry = cfg.blocks[0];
+        cfg.compute_dominators();
+    }
+    return cfg;
+}
+
+// Cooper, Harvey and Kennedy's iterative algorithm over reverse postorder
+void CFG::compute_dominators() {
+    std::vector<int> order;
+    std::vector<int> position(block_count, -1);
+    std::vector<bool> visited(block_count, false);
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    visited[0] = true;
+    while (!stack.empty()){
+        auto& [b, next] = stack.back();
+        if (next < blocks[b]->successors.size()){
+            int s = blocks[b]->successors[next++];
+            if (!visited[s]){
+                visited[s] = true;
+                stack.push_back({s, 0});
+            }
+            continue;
+        }
+        order.push_back(b);
+        stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    for (size_t k = 0; k < order.size(); k++){
+        position[order[k]] = int(k);
+    }
+
+    idom.assign(block_count, -1);
+    idom[0] = 0;
+    bool changed = true;
+    while (changed){
+        changed = false;
+        for (size_t k = 1; k < order.size(); k++){
+            int b = order[k];
+            int dominator = -1;
+            for (int p : blocks[b]->predecessors){
+                if (idom[p] == -1){
+                    continue;
+                }
+                if (dominator == -1){
+                    dominator = p;
+                    continue;
+                }
+                int x = p;
+                while (x != dominator){
+                    while (position[x] > position[dominator]){
+                        x = idom[x];
+                    }
+                    while (position[dominator] > position[x]){
+                        dominator = idom[dominator];
+                    }
+                }
+            }
+            if (dominator != idom[b]){
+                idom[b] = dominator;
+                changed = true;
+            }
+        }
+    }
+}
+
+bool CFG::relocate(const std::vector<std::shared_ptr<Instruction>>& instructions, const std::vector<int>& blocks_of) {
+    for (auto& block : blocks){
+        block->instructions.clear();
+    }
+    for (size_t k = 0; k < instructions.size(); k++){
+        auto& block = blocks[blocks_of[k]];
+        if (block->instructions.empty()){
+            block->begin = k;
+        }
+        block->instructions.push_back(instructions[k]);
+        block->end = k + 1;
+    }
+    block_of = blocks_of;
+    return std::none_of(blocks.begin(), blocks.end(), [](auto& b) { return b->instructions.empty(); });
+}
+
+bool CFG::dominates(int a, int b) const {
+    if (idom[b] == -1){
+        return false;
+    }
+    while (b != a && b != 0){
+        b = idom[b];
+    }
+    return b == a;
+}
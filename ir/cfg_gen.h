@@ -5,26 +5,58 @@
 #ifndef COMPILER_CFG_GEN_H
 #define COMPILER_CFG_GEN_H
 
+#include <unordered_map>
 #include "ir.h"
 
-
+// successors and predecessors are block ids, blocks do not own each other
 class BasicBlock {
 public:
-    static int count;
     int id;
+    // position of the block's instructions in the function
+    size_t begin = 0;
+    size_t end = 0;
     std::vector<std::shared_ptr<Instruction>> instructions;
-    std::vector<std::shared_ptr<BasicBlock>> successors;
-    BasicBlock() : id(count++) {}
+    std::vector<int> successors;
+    std::vector<int> predecessors;
+    BasicBlock(int id) : id(id) {}
 };
 
+/*
+ * Control flow graph of one function's IR, blocks are in instruction order
+ * A block starts at a label or after a branch. Returns, register jumps and tail calls
+ * (jumps to a function) leave the function, calls fall through
+ */
 class CFG {
 public:
     std::string name;
     std::shared_ptr<BasicBlock> entry;
-    std::shared_ptr<BasicBlock> exit;
+    int block_count = 0;
+    std::vector<std::shared_ptr<BasicBlock>> blocks;
+    // block of every instruction
+    std::vector<int> block_of;
+    // immediate dominator of every block, the entry is its own and unreachable blocks have -1
+    std::vector<int> idom;
+
     CFG(std::string name) : name(name) {}
-};
 
+    static CFG build(const std::vector<std::shared_ptr<Instruction>>& instructions, std::string name = "");
+
+    std::shared_ptr<BasicBlock> new_block() {
+        auto block = std::make_shared<BasicBlock>(block_count++);
+        blocks.push_back(block);
+        return block;
+    }
 
+    // keeps the blocks and edges after instructions moved between blocks, each block still contiguous and in order
+    // false when a block ran empty, the CFG must then be built again
+    bool relocate(const std::vector<std::shared_ptr<Instruction>>& instructions, const std::vector<int>& blocks);
+
+    bool dominates(int a, int b) const;
+    // opcode without the trailing spaces some are emitted with
+    static std::string trimmed(const std::string& opcode);
+
+private:
+    void compute_dominators();
+};
 
-#endif //COMPILER_CFG_GEN_H
\ No newline at end of file
+#endif //COMPILER_CFG_GEN_H
@@ -0,0 +1,163 @@
+//
+// Created by Ryan Senoune on 2025-03-18.
+//
+
+#include "dataflow.h"
+#include <algorithm>
+
+bool Operands::virtual_register(const std::shared_ptr<Register>& r) {
+    return r && r->isVirtual && !r->isMemoryOperand;
+}
+
+bool Operands::reads_flags(const std::shared_ptr<Instruction>& i) {
+    std::string opcode = CFG::trimmed(i->opcode);
+    return (!opcode.empty() && opcode[0] == 'j' && opcode != "jmp") || opcode.rfind("set", 0) == 0 || opcode.rfind("cmov", 0) == 0;
+}
+
+// virtual registers an instruction mentions, inside addresses too
+static std::vector<std::shared_ptr<Register>> mentioned_registers(const std::shared_ptr<Instruction>& i) {
+    std::vector<std::shared_ptr<Register>> result;
+    for (auto& r : i->registers){
+        std::vector<std::shared_ptr<Register>> used = {r};
+        if (auto a = std::dynamic_pointer_cast<Address>(r)){
+            used = {a->base, a->index};
+        }
+        for (auto& u : used){
+            if (u && u->isVirtual){
+                result.push_back(u);
+            }
+        }
+    }
+    return result;
+}
+
+Operands::Operands(const std::vector<std::shared_ptr<Instruction>>& instructions)
+        : mentioned(instructions.size()), assigned(instructions.size(), -1), overwrites(instructions.size(), false) {
+    for (size_t k = 0; k < instructions.size(); k++){
+        auto& i = instructions[k];
+        std::string opcode = CFG::trimmed(i->opcode);
+        bool writes = std::dynamic_pointer_cast<BasicInstruction>(i) && !i->registers.empty() && virtual_register(i->registers[0])
+                      && opcode != "cmp" && opcode != "test" && opcode != "push" && opcode != "idiv";
+
+        for (auto& r : mentioned_registers(i)){
+            auto it = ids.emplace(r->name, count);
+            if (it.second){
+                names.push_back(r->name);
+                count++;
+                next_register = std::max(next_register, std::stoi(r->name) + 1);
+            }
+            mentioned[k].push_back(it.first->second);
+        }
+        if (writes){
+            int r = mentioned[k][0];
+            assigned[k] = r;
+            // byte and word writes keep the rest of the register
+            bool whole = i->registers[0]->size >= 4 && std::count(mentioned[k].begin(), mentioned[k].end(), r) == 1;
+            overwrites[k] = whole && (opcode == "mov" || opcode == "lea" || opcode == "movzx" || opcode == "movsx" || opcode == "movsxd"
+                                      || opcode == "allocate");
+        }
+    }
+}
+
+template <typename T>
+static void reorder_values(std::vector<T>& values, const std::vector<size_t>& order) {
+    std::vector<T> result;
+    result.reserve(order.size());
+    for (size_t k : order){
+        result.push_back(std::move(values[k]));
+    }
+    values = std::move(result);
+}
+
+void Operands::reorder(const std::vector<size_t>& order) {
+    reorder_values(mentioned, order);
+    reorder_values(assigned, order);
+    std::vector<bool> moved;
+    moved.reserve(order.size());
+    for (size_t k : order){
+        moved.push_back(overwrites[k]);
+    }
+    overwrites = std::move(moved);
+}
+
+int Operands::id(const std::string& name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
+
+bool Operands::mentions(size_t k, int r) const {
+    return std::find(mentioned[k].begin(), mentioned[k].end(), r) != mentioned[k].end();
+}
+
+bool Operands::reads(size_t k, int r) const {
+    return mentions(k, r) && !(overwrites[k] && assigned[k] == r);
+}
+
+std::shared_ptr<Register> Operands::fresh() {
+    return std::make_shared<VirtualRegister>(next_register++);
+}
+
+bool Constants::immediate(const std::string& value, long& out) {
+    if (value.empty()){
+        return false;
+    }
+    size_t used = 0;
+    try {
+        out = std::stol(value, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == value.size();
+}
+
+Constants::Constants(const std::vector<std::shared_ptr<Instruction>>& instructions, const Operands& operands)
+        : is_known(operands.count, false), values(operands.count, 0) {
+    std::vector<int> assignments(operands.count, 0);
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        if (r == -1){
+            continue;
+        }
+        auto basic = std::dynamic_pointer_cast<BasicInstruction>(instructions[k]);
+        is_known[r] = ++assignments[r] == 1 && instructions[k]->opcode == "mov" && instructions[k]->registers.size() == 1
+                      && immediate(basic->value, values[r]);
+    }
+}
+
+Liveness::Liveness(const CFG& cfg, const Operands& operands) : in(cfg.block_count, std::vector<bool>(operands.count, false)) {
+    // registers read before being overwritten in each block, and the ones it overwrites
+    std::vector<std::vector<bool>> used(cfg.block_count, std::vector<bool>(operands.count, false));
+    std::vector<std::vector<bool>> killed(cfg.block_count, std::vector<bool>(operands.count, false));
+    for (auto& block : cfg.blocks){
+        for (size_t k = block->begin; k < block->end; k++){
+            for (int r : operands.mentioned[k]){
+                if (operands.reads(k, r) && !killed[block->id][r]){
+                    used[block->id][r] = true;
+                }
+            }
+            if (operands.overwrites[k]){
+                killed[block->id][operands.assigned[k]] = true;
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed){
+        changed = false;
+        for (int b = cfg.block_count - 1; b >= 0; b--){
+            std::vector<bool> out(operands.count, false);
+            for (int s : cfg.blocks[b]->successors){
+                for (int r = 0; r < operands.count; r++){
+                    out[r] = out[r] || in[s][r];
+                }
+            }
+            for (int r = 0; r < operands.count; r++){
+                bool live = used[b][r] || (out[r] && !killed[b][r]);
+                if (live != in[b][r]){
+                    in[b][r] = live;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
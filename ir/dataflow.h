@@ -0,0 +1,83 @@
+//
+// Created by Ryan Senoune on 2025-03-18.
+//
+
+#ifndef COMPILER_DATAFLOW_H
+#define COMPILER_DATAFLOW_H
+
+#include "cfg_gen.h"
+
+/*
+ * The virtual registers of one function's IR, numbered from 0, and what each instruction does with them
+ * A register is mentioned when it is an operand or the base or index of an address.
+ */
+class Operands {
+public:
+    std::vector<std::vector<int>> mentioned;
+    // register an instruction may write, -1 if none
+    std::vector<int> assigned;
+    // the assigned register is overwritten as a whole without being read
+    std::vector<bool> overwrites;
+    std::vector<std::string> names;
+    int count = 0;
+    // first register id no instruction of the function uses
+    int next_register = 0;
+
+    explicit Operands(const std::vector<std::shared_ptr<Instruction>>& instructions);
+
+    // instructions moved to the given order, order[k] being the old position of the new k-th one
+    void reorder(const std::vector<size_t>& order);
+
+    // -1 for a register the function does not mention
+    int id(const std::string& name) const;
+    bool mentions(size_t k, int r) const;
+    bool reads(size_t k, int r) const;
+    std::shared_ptr<Register> fresh();
+
+    static bool virtual_register(const std::shared_ptr<Register>& r);
+    // conditional jumps, setcc and cmov
+    static bool reads_flags(const std::shared_ptr<Instruction>& i);
+
+private:
+    std::unordered_map<std::string, int> ids;
+};
+
+/*
+ * Registers assigned once in the function, by mov r, <immediate>
+ */
+class Constants {
+public:
+    Constants(const std::vector<std::shared_ptr<Instruction>>& instructions, const Operands& operands);
+
+    bool known(int r) const {
+        return is_known[r];
+    }
+
+    long value(int r) const {
+        return values[r];
+    }
+
+    // the whole string is a decimal integer
+    static bool immediate(const std::string& value, long& out);
+
+private:
+    std::vector<bool> is_known;
+    std::vector<long> values;
+};
+
+/*
+ * Virtual registers live on entry to each block, from a backward dataflow over the CFG
+ */
+class Liveness {
+public:
+    Liveness(const CFG& cfg, const Operands& operands);
+
+    bool live_in(int block, int r) const {
+        return in[block][r];
+    }
+
+private:
+    std::vector<std::vector<bool>> in;
+};
+
+#endif //COMPILER_DATAFLOW_H
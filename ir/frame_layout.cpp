@@ -0,0 +1,147 @@
+//
+// Created by Ryan Senoune on 2025-03-16.
+//
+
+#include "frame_layout.h"
+#include <algorithm>
+
+static bool physical(const std::shared_ptr<Register>& r, const std::string& name) {
+    return r && !r->isVirtual && !r->isMemoryOperand && r->name == name;
+}
+
+// opcode r1 or opcode r1, r2 on physical registers only
+static bool is(const std::shared_ptr<Instruction>& i, const std::string& opcode, const std::string& r1, const std::string& r2 = "") {
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    if (!basic || i->opcode != opcode || !basic->value.empty() || i->registers.size() != (r2.empty() ? 1 : 2)){
+        return false;
+    }
+    return physical(i->registers[0], r1) && (r2.empty() || physical(i->registers[1], r2));
+}
+
+// a slot or an incoming stack argument
+static std::shared_ptr<Address> frame_operand(const std::shared_ptr<Register>& r) {
+    auto a = std::dynamic_pointer_cast<Address>(r);
+    return a && physical(a->base, "rbp") && !a->index ? a : nullptr;
+}
+
+static std::shared_ptr<Instruction> move_rsp(const std::string& opcode, int bytes) {
+    std::vector<std::shared_ptr<Register>> r = {Register::get_physical_register("rsp")};
+    return std::make_shared<BasicInstruction>(opcode, r, std::to_string(bytes));
+}
+
+// bytes an instruction pushes on the stack
+static int pushed(const std::shared_ptr<Instruction>& i) {
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    if (i->opcode == "push"){
+        return 8;
+    }
+    if (i->opcode == "pop"){
+        return -8;
+    }
+    if (basic && (i->opcode == "sub" || i->opcode == "add") && i->registers.size() == 1 && physical(i->registers[0], "rsp") && !basic->value.empty()){
+        return i->opcode == "sub" ? std::stoi(basic->value) : -std::stoi(basic->value);
+    }
+    return 0;
+}
+
+void FrameLayout::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    std::vector<std::shared_ptr<Instruction>> out;
+    size_t begin = 0;
+    while (begin < instructions.size()){
+        auto label = std::dynamic_pointer_cast<Label>(instructions[begin]);
+        if (!label || !label->funcDecl){
+            out.push_back(instructions[begin++]);
+            continue;
+        }
+
+        size_t end = begin + 1;
+        while (end < instructions.size()){
+            auto next = std::dynamic_pointer_cast<Label>(instructions[end]);
+            if (next && next->funcDecl){
+                break;
+            }
+            end++;
+        }
+        layout(instructions, begin, end, out);
+        begin = end;
+    }
+    instructions = std::move(out);
+}
+
+void FrameLayout::layout(std::vector<std::shared_ptr<Instruction>>& instructions, size_t begin, size_t end,
+                         std::vector<std::shared_ptr<Instruction>>& out) {
+    bool assembly = false;
+    bool leaf = true;
+    bool pushes = false;
+    bool frame_used = false;
+    int slots = 0;
+
+    for (size_t k = begin; k < end; k++){
+        auto i = instructions[k];
+        if (i->opcode == "emit_asm"){
+            assembly = true;
+        }
+        if (std::dynamic_pointer_cast<BranchInstruction>(i) && i->opcode.rfind("call", 0) == 0){
+            leaf = false;
+        }
+        if (i->opcode == "push" && !is(i, "push", "rbp")){
+            pushes = true;
+        }
+        for (auto& r : i->registers){
+            if (auto a = frame_operand(r)){
+                frame_used = true;
+                slots = std::max(slots, -a->disp);
+            }
+        }
+    }
+
+    out.push_back(instructions[begin]);
+    bool prologue = end - begin >= 3 && is(instructions[begin + 1], "push", "rbp") && is(instructions[begin + 2], "mov", "rbp", "rsp");
+    if (!prologue){
+        out.insert(out.end(), instructions.begin() + begin + 1, instructions.begin() + end);
+        return;
+    }
+
+    if (assembly || (!omit_frame_pointer && frame_used)){
+        out.push_back(instructions[begin + 1]);
+        out.push_back(instructions[begin + 2]);
+        if (slots){
+            out.push_back(move_rsp("sub", slots));
+        }
+        out.insert(out.end(), instructions.begin() + begin + 3, instructions.begin() + end);
+        return;
+    }
+
+    // rsp on entry is 8 below a 16 byte boundary, the frame keeps it there for calls
+    int frame = 0;
+    if (omit_frame_pointer && (!leaf || pushes || slots + 8 > 128)){
+        frame = (slots + 15) / 16 * 16 + 8;
+    }
+    if (frame){
+        out.push_back(move_rsp("sub", frame));
+    }
+
+    // rbp would be 8 below rsp on entry
+    int depth = 0;
+    for (size_t k = begin + 3; k < end; k++){
+        auto i = instructions[k];
+        if (k + 1 < end && is(i, "mov", "rsp", "rbp") && is(instructions[k + 1], "pop", "rbp")){
+            if (frame){
+                out.push_back(move_rsp("add", frame));
+            }
+            k++;
+            continue;
+        }
+
+        for (auto& r : i->registers){
+            if (auto a = frame_operand(r)){
+                auto moved = std::make_shared<Address>(*a);
+                moved->base = Register::get_physical_register("rsp");
+                moved->disp += frame - 8 + depth;
+                r = moved;
+            }
+        }
+        depth += pushed(i);
+        out.push_back(i);
+    }
+}
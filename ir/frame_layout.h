@@ -0,0 +1,33 @@
+//
+// Created by Ryan Senoune on 2025-03-16.
+//
+
+#ifndef COMPILER_FRAME_LAYOUT_H
+#define COMPILER_FRAME_LAYOUT_H
+
+#include "ir.h"
+
+/*
+ * Lays out each function's frame once register allocation has assigned its stack slots
+ *
+ * Slots and incoming stack arguments are addressed from rbp until here. With a frame pointer the
+ * frame is reserved below rbp, and a function that never touches its frame gets no prologue at
+ * all. Without one (-fomit-frame-pointer) rbp is neither saved nor set up, operands move to rsp,
+ * with the depth of pushes at that point added, and the frame keeps calls 16 byte aligned.
+ * A leaf that pushes nothing keeps its slots in the 128 byte red zone below rsp and needs no frame.
+ * Functions using emit_asm always keep the frame pointer, their assembly may move rsp
+ */
+class FrameLayout {
+public:
+    explicit FrameLayout(bool omit_frame_pointer) : omit_frame_pointer(omit_frame_pointer) {}
+
+    void run(std::vector<std::shared_ptr<Instruction>>& instructions);
+
+private:
+    bool omit_frame_pointer;
+
+    void layout(std::vector<std::shared_ptr<Instruction>>& instructions, size_t begin, size_t end,
+                std::vector<std::shared_ptr<Instruction>>& out);
+};
+
+#endif //COMPILER_FRAME_LAYOUT_H
@@ -0,0 +1,583 @@
+//
+// Created by Ryan Senoune on 2025-03-20.
+//
+
+#include "gvn.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+// computations numbered by their operands, without side effects besides the flags
+const std::unordered_set<std::string> pure = {"mov", "lea", "movzx", "movsx", "movsxd", "add", "sub", "imul", "and", "or", "xor",
+                                              "shl", "sar", "shr", "neg", "not"};
+// overwrite the whole destination, the others also read it
+const std::unordered_set<std::string> moves = {"mov", "lea", "movzx", "movsx", "movsxd"};
+const std::unordered_set<std::string> commutative = {"add", "imul", "and", "or", "xor"};
+// known not to touch memory besides their address operands
+const std::unordered_set<std::string> registers_only = {"cmp", "test", "push", "pop", "cqo", "cdq", "idiv", "div", "allocate", "cld",
+                                                        "nop", "ret", "leave"};
+
+bool flag_setter(const std::string& opcode) {
+    return pure.count(opcode) && !moves.count(opcode);
+}
+
+bool known(const std::string& opcode) {
+    return pure.count(opcode) || registers_only.count(opcode) || opcode.rfind("set", 0) == 0 || opcode.rfind("cmov", 0) == 0;
+}
+
+// [base + index*scale + disp] with the value numbers of base and index, index -1 when there is none
+struct Access {
+    int base;
+    int index;
+    int scale;
+    long disp;
+    int size;
+};
+
+// a load giving a value in one state of memory
+struct Fact {
+    std::string shape;
+    Access access;
+    int value;
+};
+
+class Numbering {
+public:
+    Numbering(std::vector<std::shared_ptr<Instruction>>& instructions, const Operands& operands, const CFG& cfg)
+            : instructions(instructions), operands(operands), cfg(cfg) {}
+
+    bool number();
+
+private:
+    std::vector<std::shared_ptr<Instruction>>& instructions;
+    const Operands& operands;
+    const CFG& cfg;
+
+    // value number held by every register, -1 when none is known
+    std::vector<int> value;
+    // register reads of a value number go to, valid while it still holds it
+    std::vector<int> leader;
+    // value numbers of allocate results, which are distinct stack objects
+    std::vector<bool> object;
+    // value numbers of ints sign extended from their low dword, which another movsxd keeps
+    std::vector<bool> exact;
+    // value number whose low dword a dword store forwards sign extended, -1 for other values
+    std::vector<int> narrowed;
+    std::unordered_map<std::string, int> expressions;
+    // loads known in every state of memory
+    std::vector<std::vector<Fact>> facts;
+    int memory = 0;
+
+    // undone when leaving a block of the dominator tree
+    enum class Kind {
+        Value,
+        Leader,
+        Memory
+    };
+    struct Change {
+        Kind kind;
+        int index;
+        int old;
+    };
+    std::vector<Change> changes;
+
+    std::vector<std::vector<int>> assigned_in;
+    std::vector<bool> writes_memory;
+    std::vector<bool> redundant;
+    bool changed = false;
+
+    int fresh();
+    int fresh_memory();
+    void set(int r, int v);
+    void set_memory(int version);
+    int holder(int v);
+    int of(const std::shared_ptr<Register>& r);
+    std::string operand(const std::shared_ptr<Register>& r);
+    bool access(const std::shared_ptr<Address>& a, Access& result, std::string& shape);
+    std::shared_ptr<Register> reg(int r, int size) const;
+
+    void enter(int block);
+    void visit(size_t k);
+    void substitute(size_t k);
+    int compute(size_t k, bool& replaceable);
+    void store(size_t k);
+    void rollback(size_t mark);
+};
+
+int Numbering::fresh() {
+    leader.push_back(-1);
+    object.push_back(false);
+    exact.push_back(false);
+    narrowed.push_back(-1);
+    return int(leader.size()) - 1;
+}
+
+int Numbering::fresh_memory() {
+    facts.emplace_back();
+    return int(facts.size()) - 1;
+}
+
+void Numbering::set(int r, int v) {
+    changes.push_back({Kind::Value, r, value[r]});
+    value[r] = v;
+    if (v != -1 && holder(v) == -1){
+        changes.push_back({Kind::Leader, v, leader[v]});
+        leader[v] = r;
+    }
+}
+
+void Numbering::set_memory(int version) {
+    changes.push_back({Kind::Memory, 0, memory});
+    memory = version;
+}
+
+int Numbering::holder(int v) {
+    int r = leader[v];
+    return r != -1 && value[r] == v ? r : -1;
+}
+
+void Numbering::rollback(size_t mark) {
+    while (changes.size() > mark){
+        Change& c = changes.back();
+        if (c.kind == Kind::Value){
+            value[c.index] = c.old;
+        }
+        else if (c.kind == Kind::Leader){
+            leader[c.index] = c.old;
+        }
+        else{
+            memory = c.old;
+        }
+        changes.pop_back();
+    }
+}
+
+// the value number of a virtual register, a new one when nothing is known about it
+int Numbering::of(const std::shared_ptr<Register>& r) {
+    int id = operands.id(r->name);
+    if (value[id] == -1){
+        set(id, fresh());
+    }
+    else if (holder(value[id]) == -1){
+        changes.push_back({Kind::Leader, value[id], leader[value[id]]});
+        leader[value[id]] = id;
+    }
+    return value[id];
+}
+
+// empty for operands that are not numbered
+std::string Numbering::operand(const std::shared_ptr<Register>& r) {
+    if (!Operands::virtual_register(r)){
+        return "";
+    }
+    return "v" + std::to_string(of(r)) + ":" + std::to_string(r->size);
+}
+
+bool Numbering::access(const std::shared_ptr<Address>& a, Access& result, std::string& shape) {
+    if (!Operands::virtual_register(a->base) || (a->index && !Operands::virtual_register(a->index))){
+        return false;
+    }
+    result = {of(a->base), a->index ? of(a->index) : -1, a->scale, a->disp, a->size};
+    shape = "[" + std::to_string(a->size) + " " + std::to_string(result.base) + "+" + std::to_string(result.index) + "*" +
+            std::to_string(a->scale) + "+" + std::to_string(a->disp) + "]";
+    return true;
+}
+
+std::shared_ptr<Register> Numbering::reg(int r, int size) const {
+    auto result = std::make_shared<VirtualRegister>(std::stoi(operands.names[r]));
+    result->size = size;
+    return result;
+}
+
+bool Numbering::number() {
+    value.assign(operands.count, -1);
+    redundant.assign(instructions.size(), false);
+    assigned_in.assign(cfg.block_count, {});
+    writes_memory.assign(cfg.block_count, false);
+    for (auto& block : cfg.blocks){
+        for (size_t k = block->begin; k < block->end; k++){
+            auto& i = instructions[k];
+            std::string opcode = CFG::trimmed(i->opcode);
+            if (operands.assigned[k] != -1){
+                assigned_in[block->id].push_back(operands.assigned[k]);
+            }
+            bool basic = std::dynamic_pointer_cast<BasicInstruction>(i) != nullptr;
+            bool stores = !i->registers.empty() && std::dynamic_pointer_cast<Address>(i->registers[0]) && opcode != "cmp" && opcode != "test"
+                          && opcode != "push";
+            if ((basic && (!known(opcode) || stores)) || opcode.rfind("call", 0) == 0){
+                writes_memory[block->id] = true;
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> children(cfg.block_count);
+    for (int b = 0; b < cfg.block_count; b++){
+        if (cfg.idom[b] != -1 && cfg.idom[b] != b){
+            children[cfg.idom[b]].push_back(b);
+        }
+    }
+
+    // depth first over the dominator tree, each block seeing the state its dominator ended with
+    struct Frame {
+        int block;
+        size_t mark;
+        size_t next;
+    };
+    std::vector<Frame> stack;
+    memory = fresh_memory();
+    stack.push_back({cfg.entry->id, changes.size(), 0});
+    enter(cfg.entry->id);
+    while (!stack.empty()){
+        Frame& top = stack.back();
+        if (top.next < children[top.block].size()){
+            int child = children[top.block][top.next++];
+            stack.push_back({child, changes.size(), 0});
+            enter(child);
+            continue;
+        }
+        rollback(top.mark);
+        stack.pop_back();
+    }
+
+    if (std::find(redundant.begin(), redundant.end(), true) != redundant.end()){
+        std::vector<std::shared_ptr<Instruction>> kept;
+        for (size_t k = 0; k < instructions.size(); k++){
+            if (!redundant[k]){
+                kept.push_back(instructions[k]);
+            }
+        }
+        instructions = std::move(kept);
+        changed = true;
+    }
+    return changed;
+}
+
+// forgets what the way from the immediate dominator may change, then numbers the block
+void Numbering::enter(int block) {
+    int dominator = cfg.idom[block];
+    if (dominator != block){
+        // blocks reaching this one without passing the dominator, all of them are reached from it
+        std::vector<bool> between(cfg.block_count, false);
+        std::vector<int> work;
+        for (int p : cfg.blocks[block]->predecessors){
+            if (p != dominator && !between[p]){
+                between[p] = true;
+                work.push_back(p);
+            }
+        }
+        bool written = false;
+        while (!work.empty()){
+            int b = work.back();
+            work.pop_back();
+            written = written || writes_memory[b];
+            for (int r : assigned_in[b]){
+                if (value[r] != -1){
+                    set(r, -1);
+                }
+            }
+            for (int p : cfg.blocks[b]->predecessors){
+                if (p != dominator && !between[p]){
+                    between[p] = true;
+                    work.push_back(p);
+                }
+            }
+        }
+        if (written){
+            set_memory(fresh_memory());
+        }
+    }
+
+    for (size_t k = cfg.blocks[block]->begin; k < cfg.blocks[block]->end; k++){
+        visit(k);
+    }
+}
+
+void Numbering::visit(size_t k) {
+    auto& i = instructions[k];
+    std::string opcode = CFG::trimmed(i->opcode);
+    if (std::dynamic_pointer_cast<Label>(i)){
+        return;
+    }
+    if (std::dynamic_pointer_cast<BranchInstruction>(i)){
+        if (opcode.rfind("call", 0) == 0){
+            set_memory(fresh_memory());
+        }
+        return;
+    }
+
+    if (known(opcode)){
+        substitute(k);
+    }
+    int r = operands.assigned[k];
+    if (r != -1){
+        bool replaceable = false;
+        int v = compute(k, replaceable);
+        // flags set here may be read next
+        bool flags = k + 1 < instructions.size() && Operands::reads_flags(instructions[k + 1]) && flag_setter(opcode);
+        if (opcode == "allocate"){
+            object[v] = true;
+        }
+        if (v == value[r] && pure.count(opcode) && !flags){
+            redundant[k] = true;
+        }
+        else if (replaceable && !flags && holder(v) != -1 && holder(v) != r){
+            instructions[k] = std::make_shared<BasicInstruction>("mov", std::vector<std::shared_ptr<Register>>{reg(r, 8), reg(holder(v), 8)});
+            changed = true;
+        }
+        // a dword load of what was just stored extends the stored register instead
+        else if (replaceable && !flags && holder(v) == -1 && narrowed[v] != -1 && holder(narrowed[v]) != -1){
+            instructions[k] = std::make_shared<BasicInstruction>("movsxd", std::vector<std::shared_ptr<Register>>{reg(r, 8),
+                                                                                                                 reg(holder(narrowed[v]), 4)});
+            changed = true;
+        }
+        set(r, v);
+    }
+
+    if (!known(opcode)){
+        set_memory(fresh_memory());
+    }
+    else if (!i->registers.empty() && std::dynamic_pointer_cast<Address>(i->registers[0]) && opcode != "cmp" && opcode != "test"
+             && opcode != "push"){
+        store(k);
+    }
+}
+
+// reads go to the register that first held their value
+void Numbering::substitute(size_t k) {
+    auto& i = instructions[k];
+    std::vector<std::shared_ptr<Register>> registers = i->registers;
+    bool renamed = false;
+    auto rename = [&](const std::shared_ptr<Register>& r) -> std::shared_ptr<Register> {
+        if (!Operands::virtual_register(r)){
+            return r;
+        }
+        int id = operands.id(r->name);
+        int h = holder(of(r));
+        if (h == id){
+            return r;
+        }
+        renamed = true;
+        auto result = reg(h, r->size);
+        return result;
+    };
+    for (size_t j = 0; j < registers.size(); j++){
+        if (auto a = std::dynamic_pointer_cast<Address>(registers[j])){
+            auto base = a->base ? rename(a->base) : nullptr;
+            auto index = a->index ? rename(a->index) : nullptr;
+            if (base != a->base || index != a->index){
+                auto moved = std::make_shared<Address>(*a);
+                moved->base = base;
+                moved->index = index;
+                registers[j] = moved;
+            }
+        }
+        else if (j > 0 || operands.assigned[k] == -1){
+            registers[j] = rename(registers[j]);
+        }
+    }
+    if (!renamed){
+        return;
+    }
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    instructions[k] = std::make_shared<BasicInstruction>(i->opcode, registers, basic->value);
+    changed = true;
+}
+
+// the value number of what instruction k assigns, replaceable when a copy of it could do the same
+int Numbering::compute(size_t k, bool& replaceable) {
+    auto& i = instructions[k];
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    std::string opcode = CFG::trimmed(i->opcode);
+    auto& registers = i->registers;
+    if (!pure.count(opcode) || registers[0]->size < 4 || registers.size() > 2 || (registers.size() == 2 && !basic->value.empty())){
+        return fresh();
+    }
+
+    std::string key = opcode + " " + std::to_string(registers[0]->size);
+    std::vector<std::string> sources;
+    if (!moves.count(opcode)){
+        sources.push_back(operand(registers[0]));
+    }
+    std::string shape;
+    Access load{};
+    bool loads = false;
+    if (registers.size() == 2){
+        if (auto a = std::dynamic_pointer_cast<Address>(registers[1])){
+            if (!moves.count(opcode) || !access(a, load, shape)){
+                return fresh();
+            }
+            loads = opcode != "lea";
+            sources.push_back(shape);
+        }
+        else if (opcode == "mov" && registers[0]->size == 8 && registers[1]->size == 8 && Operands::virtual_register(registers[1])){
+            return of(registers[1]);
+        }
+        else if (opcode == "movsxd" && Operands::virtual_register(registers[1]) && exact[of(registers[1])]){
+            return of(registers[1]);
+        }
+        else{
+            sources.push_back(operand(registers[1]));
+        }
+    }
+    else if (!basic->value.empty()){
+        sources.push_back("i" + basic->value);
+    }
+    else if (moves.count(opcode)){
+        return fresh();
+    }
+    if (std::find(sources.begin(), sources.end(), "") != sources.end()){
+        return fresh();
+    }
+    if (commutative.count(opcode)){
+        std::sort(sources.begin(), sources.end());
+    }
+    for (auto& s : sources){
+        key += " " + s;
+    }
+    std::string shaped = key;
+    if (loads){
+        key += "@" + std::to_string(memory);
+    }
+
+    // an immediate is cheaper than the copy
+    replaceable = opcode != "mov" || registers.size() == 2;
+    auto it = expressions.find(key);
+    if (it != expressions.end()){
+        return it->second;
+    }
+    int v = fresh();
+    expressions[key] = v;
+    exact[v] = registers[0]->size == 8 && (opcode == "movsxd" || opcode == "movsx" || opcode == "movzx");
+    if (loads){
+        facts[memory].push_back({shaped, load, v});
+    }
+    return v;
+}
+
+// a new state of memory keeping the loads the store cannot change, and the stored value
+void Numbering::store(size_t k) {
+    auto& i = instructions[k];
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    auto a = std::dynamic_pointer_cast<Address>(i->registers[0]);
+    Access target{};
+    std::string shape;
+    int version = fresh_memory();
+    if (!access(a, target, shape)){
+        set_memory(version);
+        return;
+    }
+
+    auto disjoint = [&](const Access& other) {
+        if (other.base == target.base && other.index == target.index && other.scale == target.scale){
+            return other.disp + other.size <= target.disp || target.disp + target.size <= other.disp;
+        }
+        return other.base != target.base && object[other.base] && object[target.base];
+    };
+    for (size_t f = 0; f < facts[memory].size(); f++){
+        Fact fact = facts[memory][f];
+        if (disjoint(fact.access)){
+            expressions[fact.shape + "@" + std::to_string(version)] = fact.value;
+            facts[version].push_back(fact);
+        }
+    }
+
+    // ints wrap at 32 bits, a dword reads back as the stored register sign extended from its low dword,
+    // which is what movsxd of it computes
+    int stored = -1;
+    if (CFG::trimmed(i->opcode) == "mov" && i->registers.size() == 2 && Operands::virtual_register(i->registers[1])){
+        stored = of(i->registers[1]);
+        if (a->size == 4 && !exact[stored]){
+            std::string key = "movsxd 8 " + operand(i->registers[1]);
+            auto it = expressions.find(key);
+            if (it == expressions.end()){
+                it = expressions.emplace(key, fresh()).first;
+                exact[it->second] = true;
+                narrowed[it->second] = stored;
+            }
+            stored = it->second;
+        }
+    }
+    else if (CFG::trimmed(i->opcode) == "mov" && i->registers.size() == 1 && !basic->value.empty()){
+        auto it = expressions.find("mov 8 i" + basic->value);
+        stored = it == expressions.end() ? -1 : it->second;
+    }
+    std::string loaded;
+    if (stored != -1 && a->size == 8){
+        loaded = "mov 8 " + shape;
+    }
+    else if (stored != -1 && a->size == 4){
+        loaded = "movsxd 8 " + shape;
+    }
+    if (!loaded.empty()){
+        expressions[loaded + "@" + std::to_string(version)] = stored;
+        facts[version].push_back({loaded, target, stored});
+    }
+    set_memory(version);
+}
+
+// deletes instructions only computing registers nobody reads, until none is left
+bool eliminate(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    bool changed = false;
+    while (true){
+        CFG cfg = CFG::build(instructions);
+        Operands operands(instructions);
+        Liveness liveness(cfg, operands);
+        std::vector<bool> removed(instructions.size(), false);
+        bool any = false;
+        for (auto& block : cfg.blocks){
+            std::vector<bool> live(operands.count, false);
+            for (int s : block->successors){
+                for (int r = 0; r < operands.count; r++){
+                    live[r] = live[r] || liveness.live_in(s, r);
+                }
+            }
+            // the flags are never live across blocks
+            bool flags = false;
+            for (size_t k = block->end; k-- > block->begin;){
+                auto& i = instructions[k];
+                std::string opcode = CFG::trimmed(i->opcode);
+                int r = operands.assigned[k];
+                bool removable = (pure.count(opcode) || opcode.rfind("set", 0) == 0) && !(flags && flag_setter(opcode));
+                if (r != -1 && removable && !live[r]){
+                    removed[k] = any = true;
+                    continue;
+                }
+                if (Operands::reads_flags(i)){
+                    flags = true;
+                }
+                else if (flag_setter(opcode) || opcode == "cmp" || opcode == "test"){
+                    flags = false;
+                }
+                if (r != -1 && operands.overwrites[k]){
+                    live[r] = false;
+                }
+                for (int m : operands.mentioned[k]){
+                    if (operands.reads(k, m)){
+                        live[m] = true;
+                    }
+                }
+            }
+        }
+        if (!any){
+            return changed;
+        }
+        std::vector<std::shared_ptr<Instruction>> kept;
+        for (size_t k = 0; k < instructions.size(); k++){
+            if (!removed[k]){
+                kept.push_back(instructions[k]);
+            }
+        }
+        instructions = std::move(kept);
+        changed = true;
+    }
+}
+
+}
+
+bool GlobalValueNumbering::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    CFG cfg = CFG::build(instructions);
+    Operands operands(instructions);
+    bool changed = Numbering(instructions, operands, cfg).number();
+    return eliminate(instructions) || changed;
+}
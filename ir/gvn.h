@@ -0,0 +1,30 @@
+//
+// Created by Ryan Senoune on 2025-03-20.
+//
+
+#ifndef COMPILER_GVN_H
+#define COMPILER_GVN_H
+
+#include "pass.h"
+#include "dataflow.h"
+
+/*
+ * Global value numbering over the dominator tree, with redundant load elimination
+ *
+ * Every value a register holds gets a number, equal numbers being equal values: a copy keeps the number,
+ * a computation (mov, lea, add, imul, shl, movsxd...) is numbered by its opcode, sizes and the numbers of
+ * its operands, a load also by the state of memory. A computation whose number some register already
+ * holds becomes a copy of it, and every register read is replaced by the first register holding the
+ * same number, so p->x used three times is loaded once. A store makes a new state of memory, keeping
+ * the loads it cannot overwrite (another offset from the same base, another stack object) and what it
+ * stored for a load of the same address. Calls and anything else writing memory forget every load.
+ *
+ * Blocks start from the state at the end of their immediate dominator, minus the registers assigned and
+ * the memory written on the way from there. Instructions left without a use are deleted afterwards.
+ */
+class GlobalValueNumbering : public Pass {
+public:
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+};
+
+#endif //COMPILER_GVN_H
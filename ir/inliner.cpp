@@ -0,0 +1,250 @@
+//
+// Created by Ryan Senoune on 2025-03-15.
+//
+
+#include "inliner.h"
+#include <algorithm>
+
+Inliner::Inliner(std::shared_ptr<Program> program, int budget) : budget(budget) {
+    std::unordered_set<std::string> redefined;
+    for (auto d : program->decls){
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(d); f && f->name != "emit_asm"){
+            if (!functions.emplace(f->name, f).second){
+                redefined.insert(f->name);
+            }
+        }
+    }
+    // semantic analysis reports a redefinition, until then neither is inlined
+    for (auto& name : redefined){
+        functions.erase(name);
+    }
+
+    program->accept(*this);
+
+    for (auto d : program->decls){
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(d); f && nodes.count(f) && nodes[f].index < 0){
+            connect(f);
+        }
+    }
+}
+
+int Inliner::preset(int level) {
+    return level >= 2 ? 32 : 0;
+}
+
+std::shared_ptr<FuncDecl> Inliner::callee(std::shared_ptr<Call> call) const {
+    auto it = functions.find(call->identifier->value);
+    if (it == functions.end() || !inlinable.count(it->second) || it->second->args.size() != call->args.size()){
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool Inliner::inlined(std::shared_ptr<FuncDecl> f) const {
+    return inlinable.count(f);
+}
+
+// argument moves, the call, the stack cleanup past six arguments and the move of rax
+int Inliner::call_size(int args) {
+    return std::min(args, 6) + std::max(args - 6, 0) + (args > 6 ? 1 : 0) + 2;
+}
+
+// Tarjan's algorithm, which completes the components callees first
+void Inliner::connect(std::shared_ptr<FuncDecl> f) {
+    Node& node = nodes[f];
+    node.index = node.low = next_index++;
+    node.on_stack = true;
+    stack.push_back(f);
+
+    for (auto& site : node.sites){
+        Node& callee = nodes[site.callee];
+        if (callee.index < 0){
+            connect(site.callee);
+            node.low = std::min(node.low, callee.low);
+        }
+        else if (callee.on_stack){
+            node.low = std::min(node.low, callee.index);
+        }
+    }
+
+    if (node.low != node.index){
+        return;
+    }
+
+    std::vector<std::shared_ptr<FuncDecl>> component;
+    std::shared_ptr<FuncDecl> member;
+    do {
+        member = stack.back();
+        stack.pop_back();
+        nodes[member].on_stack = false;
+        component.push_back(member);
+    } while (member != f);
+
+    decide(component);
+}
+
+/*
+ * Callees outside the component are already decided, an inlined one replaces the call with its
+ * body and the moves binding its parameters. A component of several functions, or a function
+ * calling itself, is recursive and never inlined
+ */
+void Inliner::decide(const std::vector<std::shared_ptr<FuncDecl>>& component) {
+    bool recursive = component.size() > 1;
+    for (auto& f : component){
+        Node& node = nodes[f];
+        for (auto& site : node.sites){
+            if (site.callee == f){
+                recursive = true;
+            }
+            if (inlinable.count(site.callee) && site.args == site.callee->args.size()){
+                node.size += site.args + nodes[site.callee].size - call_size(site.args);
+            }
+        }
+    }
+
+    if (recursive){
+        return;
+    }
+    for (auto& f : component){
+        if (!nodes[f].opaque && nodes[f].size <= budget){
+            inlinable.insert(f);
+        }
+    }
+}
+
+void Inliner::visit(std::shared_ptr<Program> program) {
+    for (auto d : program->decls){
+        d->accept(*this);
+    }
+}
+
+// the prologue and epilogue are not counted, they are what inlining saves
+void Inliner::visit(std::shared_ptr<FuncDecl> func) {
+    if (func->name == "emit_asm"){
+        return;
+    }
+    current = &nodes[func];
+    func->block->accept(*this);
+    current = nullptr;
+}
+
+void Inliner::visit(std::shared_ptr<Block> block) {
+    for (auto s : block->stmts){
+        s->accept(*this);
+    }
+}
+
+void Inliner::visit(std::shared_ptr<If> i) {
+    current->size += i->stmt2.has_value() ? 3 : 2;
+    i->expr1->accept(*this);
+    i->stmt1->accept(*this);
+    if (i->stmt2.has_value()){
+        i->stmt2->get()->accept(*this);
+    }
+}
+
+void Inliner::visit(std::shared_ptr<While> w) {
+    current->size += 3;
+    w->expr->accept(*this);
+    w->stmt->accept(*this);
+}
+
+void Inliner::visit(std::shared_ptr<Continue> c) {
+    current->size += 1;
+}
+
+void Inliner::visit(std::shared_ptr<Break> b) {
+    current->size += 1;
+}
+
+void Inliner::visit(std::shared_ptr<Return> ret) {
+    current->size += 1;
+    if (ret->expr.has_value()){
+        current->size += 1;
+        ret->expr->get()->accept(*this);
+    }
+}
+
+void Inliner::visit(std::shared_ptr<Call> call) {
+    if (call->identifier->value == "emit_asm"){
+        current->opaque = true;
+        return;
+    }
+
+    current->size += call_size(call->args.size());
+    if (auto it = functions.find(call->identifier->value); it != functions.end()){
+        current->sites.push_back({it->second, int(call->args.size())});
+    }
+    for (auto a : call->args){
+        a->accept(*this);
+    }
+}
+
+void Inliner::visit(std::shared_ptr<Unary> unary) {
+    switch (unary->op->token_type) {
+        case TT::NOT:
+            current->size += 4;
+            break;
+        case TT::MINUS:
+            current->size += 2;
+            break;
+        default:
+            current->size += 1;
+            break;
+    }
+    unary->expr1->accept(*this);
+}
+
+void Inliner::visit(std::shared_ptr<TypeCast> typeCast) {
+    current->size += 1;
+    typeCast->expr1->accept(*this);
+}
+
+void Inliner::visit(std::shared_ptr<Binary> binary) {
+    switch (binary->op->token_type) {
+        case TT::ASSIGN:
+            current->size += 1;
+            break;
+        case TT::DIV:
+        case TT::REM:
+            current->size += 5;
+            break;
+        case TT::LE:
+        case TT::LT:
+        case TT::GE:
+        case TT::GT:
+        case TT::EQ:
+        case TT::NE:
+            current->size += 4;
+            break;
+        default:
+            current->size += 2;
+            break;
+    }
+    binary->expr1->accept(*this);
+    binary->expr2->accept(*this);
+}
+
+// an identifier is its variable's register, loads of memory variables are not known before analysis
+void Inliner::visit(std::shared_ptr<Primary> primary) {
+    if (primary->token->token_type != TT::IDENTIFIER){
+        current->size += 1;
+    }
+}
+
+void Inliner::visit(std::shared_ptr<Subscript> subscript) {
+    current->size += 1;
+    subscript->array->accept(*this);
+    subscript->index->accept(*this);
+}
+
+void Inliner::visit(std::shared_ptr<Member> member) {
+    current->size += 1;
+    member->structure->accept(*this);
+}
+
+// declarations only reserve a register or a stack slot
+void Inliner::visit(std::shared_ptr<VarDecl> varDecl) {}
+void Inliner::visit(std::shared_ptr<Type> type) {}
+void Inliner::visit(std::shared_ptr<FunProto> funProto) {}
+void Inliner::visit(std::shared_ptr<StructDecl> structDecl) {}
@@ -0,0 +1,82 @@
+//
+// Created by Ryan Senoune on 2025-03-15.
+//
+
+#ifndef COMPILER_INLINER_H
+#define COMPILER_INLINER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include "../parser/ast.h"
+
+/*
+ * Picks the calls InstructionGen expands in place
+ *
+ * Works on the AST before semantic analysis, so function fingerprints can include the callees
+ * inlined into them. The call graph is walked bottom-up by strongly connected components: the size
+ * of a function already counts the callees inlined into it, and functions on a cycle (fibonnaci
+ * calling itself) stay calls. A callee is inlined when its estimated instruction count fits the budget
+ */
+class Inliner : public Visitor<void> {
+public:
+    Inliner(std::shared_ptr<Program> program, int budget);
+
+    // budget of an -O level, 0 when it does not inline
+    static int preset(int level);
+
+    // the function expanded at this call, null when it stays a call
+    std::shared_ptr<FuncDecl> callee(std::shared_ptr<Call> call) const;
+    bool inlined(std::shared_ptr<FuncDecl> f) const;
+
+private:
+    struct Site {
+        std::shared_ptr<FuncDecl> callee;
+        int args;
+    };
+
+    struct Node {
+        int size = 0;
+        // calls emit_asm, which expects the function's own frame and argument registers
+        bool opaque = false;
+        std::vector<Site> sites;
+
+        int index = -1;
+        int low = 0;
+        bool on_stack = false;
+    };
+
+    int budget;
+    std::unordered_map<std::string, std::shared_ptr<FuncDecl>> functions;
+    std::unordered_map<std::shared_ptr<FuncDecl>, Node> nodes;
+    std::unordered_set<std::shared_ptr<FuncDecl>> inlinable;
+
+    std::vector<std::shared_ptr<FuncDecl>> stack;
+    int next_index = 0;
+    Node* current = nullptr;
+
+    static int call_size(int args);
+    void connect(std::shared_ptr<FuncDecl> f);
+    void decide(const std::vector<std::shared_ptr<FuncDecl>>& component);
+
+    void visit(std::shared_ptr<Program> program) override;
+    void visit(std::shared_ptr<FuncDecl> func) override;
+    void visit(std::shared_ptr<FunProto> funProto) override;
+    void visit(std::shared_ptr<Block> block) override;
+    void visit(std::shared_ptr<If> i) override;
+    void visit(std::shared_ptr<While> w) override;
+    void visit(std::shared_ptr<Continue> c) override;
+    void visit(std::shared_ptr<Break> b) override;
+    void visit(std::shared_ptr<Return> ret) override;
+    void visit(std::shared_ptr<VarDecl> varDecl) override;
+    void visit(std::shared_ptr<Type> type) override;
+    void visit(std::shared_ptr<Call> call) override;
+    void visit(std::shared_ptr<StructDecl> structDecl) override;
+    void visit(std::shared_ptr<Unary> unary) override;
+    void visit(std::shared_ptr<TypeCast> typeCast) override;
+    void visit(std::shared_ptr<Binary> binary) override;
+    void visit(std::shared_ptr<Primary> primary) override;
+    void visit(std::shared_ptr<Subscript> subscript) override;
+    void visit(std::shared_ptr<Member> member) override;
+};
+
+#endif //COMPILER_INLINER_H
@@ -3,9 +3,12 @@
 //
 
 #include "instruction_gen.h"
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include "selector.h"
 
-int VirtualRegister::count = 0;
-std::vector<std::shared_ptr<Register>> Register::registers = {
+const std::vector<std::shared_ptr<const Register>> Register::registers = {
         // General-purpose registers for temporary use
         std::make_shared<Register>("r10", "r10d", "r10w", "r10b"),
         std::make_shared<Register>("r11", "r11d", "r11w", "r11b"),
@@ -26,6 +29,9 @@ std::vector<std::shared_ptr<Register>> Register::registers = {
         std::make_shared<Register>("rcx", "ecx", "cx", "cl"),   // 4th argument
         std::make_shared<Register>("r8", "r8d", "r8w", "r8b"),  // 5th argument
         std::make_shared<Register>("r9", "r9d", "r9w", "r9b"),  // 6th argument
+
+        // scratch for block copies
+        std::make_shared<Register>("xmm15", "xmm15", "xmm15", "xmm15"),
 };
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Program> p) {
@@ -41,62 +47,77 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<FuncDecl> f) {
         return NO_REGISTER;
     }
 
+    size_t start = instructions.size();
+    int first_label = label_id;
+    int first_register = register_id;
+    function = f;
+    tail_label = "";
+    tail_called = false;
+    allocated = false;
+
     emit_label(f->name, true);
 
     emit("push", Register::get_physical_register("rbp"));
     emit("mov", Register::get_physical_register("rbp"),Register::get_physical_register("rsp"));
 
-    for (int i = 0; i<std::min(f->args.size(), static_cast<size_t>(6));i++) {
-        f->args[i]->accept(*this);
-
-        // copying struct
-        if (f->args[i]->type->token->token_type == TT::STRUCT){
+    std::vector<std::shared_ptr<Type>> types;
+    for (auto a : f->args){
+        types.push_back(a->type);
+    }
+    std::vector<ArgLocation> locations = classify(types);
 
-            for (auto r : arg_reg_order){
-                emit("push", Register::get_physical_register(r));
-            }
+    // structs passed by address are copied once every argument register has been read
+    std::vector<std::pair<std::shared_ptr<VarDecl>, std::shared_ptr<Register>>> copies;
+    int offset = 16;
 
-            auto a = f->args[i];
-            int size = std::dynamic_pointer_cast<StructDecl>(a->type->symbol->decl)->size;
-            emit("mov", Register::get_physical_register("rsi"), Register::get_physical_register(arg_reg_order[i])); // source
-            emit("mov", Register::get_physical_register("rdi"), symbol_table[a]); // dest
-            emit("mov", Register::get_physical_register("rcx"), std::to_string(size/8));
-            emit("cld");
-            emit("rep movsq");
+    for (int i = 0; i < f->args.size(); i++) {
+        auto a = f->args[i];
+        a->accept(*this);
+        ArgLocation& l = locations[i];
 
-            for (int i=arg_reg_order.size()-1;i>=0;i--){
-                emit("pop", Register::get_physical_register(arg_reg_order[i]));
+        if (l.by_value){
+            for (int k = 0; k < l.count; k++){
+                auto part = std::make_shared<Address>(symbol_table[a]);
+                part->disp = 8 * k;
+                emit("mov", part, Register::get_physical_register(arg_reg_order[l.reg + k]));
             }
-
             continue;
         }
 
-        auto arg = symbol_table[f->args[i]];
-        emit("mov", arg,Register::get_physical_register(arg_reg_order[i]));
-    }
-
-    int offset = 16;
+        std::shared_ptr<Register> arg;
+        if (l.count){
+            arg = Register::get_physical_register(arg_reg_order[l.reg]);
+        }
+        else{
+            auto incoming = std::make_shared<Address>(Register::get_physical_register("rbp"));
+            incoming->disp = offset;
+            offset += 8;
+            arg = gen_register();
+            emit("mov", arg, incoming);
+        }
 
-    for (int i = 6; i < f->args.size();i++){
-        f->args[i]->accept(*this);
-
-        // copying struct
-        if (f->args[i]->type->token->token_type == TT::STRUCT){
-            auto a = f->args[i];
-            int size = std::dynamic_pointer_cast<StructDecl>(a->type->symbol->decl)->size;
-            emit("mov", Register::get_physical_register("rsi"), "[rbp + " + std::to_string(offset) + "]"); // source
-            emit("mov", Register::get_physical_register("rdi"), symbol_table[a]); // dest
-            emit("mov", Register::get_physical_register("rcx"), std::to_string(size/8));
-            emit("cld");
-            emit("rep movsq");
-            continue;
+        if (a->type->is_aggregate()){
+            if (l.count){
+                std::shared_ptr<VirtualRegister> address = gen_register();
+                emit("mov", address, arg);
+                arg = address;
+            }
+            copies.emplace_back(a, arg);
         }
+        else if (in_memory(a)){
+            store(std::make_shared<Address>(symbol_table[a]), arg, a->type);
+        }
+        else{
+            emit("mov", symbol_table[a], arg);
+        }
+    }
 
-        emit("mov", symbol_table[f->args[i]], "[rbp + " + std::to_string(offset) + "]");
-        offset += 8;
+    for (auto& [a, address] : copies){
+        copy(symbol_table[a], address, a->type->size);
     }
 
     return_label = gen_label("ret");
+    size_t body = instructions.size();
 
     f->block->accept(*this);
 
@@ -105,6 +126,21 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<FuncDecl> f) {
     emit("pop", Register::get_physical_register("rbp"));
     emit_branch("ret","");
 
+    // a pointer to an object of this frame may reach the callee, or the next iteration of a self call
+    if (tail_called && allocated){
+        instructions.resize(start);
+        label_id = first_label;
+        register_id = first_register;
+        tail_calls = false;
+        visit(f);
+        tail_calls = true;
+        return NO_REGISTER;
+    }
+
+    if (!tail_label.empty()){
+        instructions.insert(instructions.begin() + body, std::make_shared<Label>(tail_label, false));
+    }
+
     return NO_REGISTER;
 }
 
@@ -114,16 +150,29 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Call> c) {
         return NO_REGISTER;
     }
 
-    for (int i = 0; i<std::min(c->args.size(), static_cast<size_t>(6));i++) {
-        auto arg = c->args[i]->accept(*this);
-        emit("mov", Register::get_physical_register(arg_reg_order[i]), arg);
+    if (auto f = inliner ? inliner->callee(c) : nullptr){
+        return inline_call(c, f);
+    }
+
+    // every argument is evaluated before the argument registers are set, calls and
+    // struct copies inside an argument would clobber them
+    std::vector<Operand> args;
+    std::vector<std::shared_ptr<Type>> types;
+    for (auto a : c->args){
+        args.push_back(operand(a));
+        types.push_back(a->type);
     }
 
+    std::vector<ArgLocation> locations = classify(types);
+    set_arg_registers(args, locations);
+
     int stack_size = 0;
 
-    for (int i = c->args.size()-1; i >= 6;i--){
-        emit("push", c->args[i]->accept(*this));
-        stack_size += 8;
+    for (int i = c->args.size()-1; i >= 0;i--){
+        if (!locations[i].count){
+            emit("push", args[i]);
+            stack_size += 8;
+        }
     }
 
     emit_branch("call", c->identifier->value);
@@ -137,34 +186,168 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Call> c) {
     return res;
 }
 
+/*
+ * Lowers `return f(...)` without a frame for the call. A self call moves the arguments to the
+ * parameters and jumps back to the start of the body, another call sets the argument registers,
+ * tears down the frame and jumps to the callee, which returns to our caller.
+ * Calls passing arguments on the stack, inlined calls and emit_asm are left alone
+ */
+bool InstructionGen::tail_call(std::shared_ptr<Call> c) {
+    bool self = c->identifier->value == function->name;
+    if (c->identifier->value == "emit_asm" || (inliner && inliner->callee(c))){
+        return false;
+    }
+
+    std::vector<std::shared_ptr<Type>> types;
+    for (auto a : c->args){
+        types.push_back(a->type);
+    }
+    std::vector<ArgLocation> locations = classify(types);
+    if (!self && std::any_of(locations.begin(), locations.end(), [](const ArgLocation& l) { return l.count == 0; })){
+        return false;
+    }
+
+    std::vector<Operand> args;
+    for (auto a : c->args){
+        args.push_back(operand(a));
+    }
+    tail_called = true;
+
+    if (!self){
+        set_arg_registers(args, locations);
+        emit("mov", Register::get_physical_register("rsp"), Register::get_physical_register("rbp"));
+        emit("pop", Register::get_physical_register("rbp"));
+        emit_branch("jmp", c->identifier->value);
+        return true;
+    }
+
+    // an argument held in another parameter's register is read before the parameters are overwritten
+    for (int i = 0; i < args.size(); i++){
+        for (int j = 0; j < args.size(); j++){
+            if (j != i && args[i].reg && args[i].reg == symbol_table[function->args[j]]){
+                std::shared_ptr<VirtualRegister> saved = gen_register();
+                emit("mov", saved, args[i]);
+                args[i] = Operand(saved);
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < args.size(); i++){
+        if (args[i].reg != symbol_table[function->args[i]]){
+            emit("mov", symbol_table[function->args[i]], args[i]);
+        }
+    }
+
+    if (tail_label.empty()){
+        tail_label = gen_label("tail");
+    }
+    emit_branch("jmp", tail_label);
+    return true;
+}
+
+/*
+ * SysV style classification of the arguments of a call, in order. A struct of up to 16 bytes
+ * goes by value in one or two registers when enough are left, any other struct by address,
+ * which the callee copies. Arguments that find no register are pushed, one qword each
+ */
+std::vector<InstructionGen::ArgLocation> InstructionGen::classify(const std::vector<std::shared_ptr<Type>>& types) {
+    std::vector<ArgLocation> locations;
+    int next = 0;
+    for (auto& t : types){
+        ArgLocation l;
+        // arrays decay to their address, only structs are passed by value
+        bool small = t->is_aggregate() && t->arraySize.empty() && t->size <= 16;
+        int count = small ? (t->size + 7) / 8 : 1;
+        if (next + count <= arg_reg_order.size()){
+            l.reg = next;
+            l.count = count;
+            l.by_value = small;
+            next += count;
+        }
+        locations.push_back(l);
+    }
+    return locations;
+}
+
+// a struct passed by value is loaded a qword at a time, its storage is padded to 8 bytes
+void InstructionGen::set_arg_registers(const std::vector<Operand>& args, const std::vector<ArgLocation>& locations) {
+    for (int i = 0; i < args.size(); i++){
+        const ArgLocation& l = locations[i];
+        if (l.by_value){
+            for (int k = 0; k < l.count; k++){
+                auto part = std::make_shared<Address>(args[i].reg);
+                part->disp = 8 * k;
+                emit("mov", Register::get_physical_register(arg_reg_order[l.reg + k]), part);
+            }
+        }
+        else if (l.count){
+            emit("mov", Register::get_physical_register(arg_reg_order[l.reg]), args[i]);
+        }
+    }
+}
+
+/*
+ * Generates the callee's body in place of the call, its parameters are fresh registers bound to the
+ * arguments and a return moves its value to the result register and jumps past the body
+ */
+std::shared_ptr<Register> InstructionGen::inline_call(std::shared_ptr<Call> c, std::shared_ptr<FuncDecl> f) {
+    std::vector<Operand> args;
+    for (auto a : c->args){
+        args.push_back(operand(a));
+    }
+
+    for (int i = 0; i < f->args.size(); i++){
+        auto a = f->args[i];
+        a->accept(*this);
+
+        if (a->type->is_aggregate()){
+            copy(symbol_table[a], args[i].reg, a->type->size);
+        }
+        else if (in_memory(a)){
+            store(std::make_shared<Address>(symbol_table[a]), args[i], a->type);
+        }
+        else{
+            emit("mov", symbol_table[a], args[i]);
+        }
+    }
+
+    std::string caller_label = return_label;
+    std::shared_ptr<VirtualRegister> caller_value = return_value;
+    return_label = gen_label("inline");
+    return_value = gen_register();
+
+    std::shared_ptr<VirtualRegister> res = return_value;
+    f->block->accept(*this);
+    emit_label(return_label, false);
+
+    return_label = caller_label;
+    return_value = caller_value;
+    return res;
+}
+
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Block> b) {
     for (auto s : b->stmts){
-        s->accept(*this);
+        statement(s);
     }
 
     return NO_REGISTER;
 }
 
+// an assignment as a statement may update the variable in place, nothing reads its value
+void InstructionGen::statement(std::shared_ptr<Stmt> s) {
+    discarded = std::dynamic_pointer_cast<Binary>(s) != nullptr;
+    s->accept(*this);
+    discarded = false;
+}
+
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<VarDecl> v) {
     if (v->is_local){
         symbol_table[v] = gen_register();
 
-        if (v->type->token->token_type == TT::STRUCT && v->type->pointerCount == 0){
-            /*
-            emit("sub", Register::get_physical_register("rsp"), std::to_string(std::dynamic_pointer_cast<StructDecl>(v->type->symbol->decl)->size));
-            emit("mov", symbol_table[v], Register::get_physical_register("rsp"));
-            */
-            std::shared_ptr<StructDecl> rr = std::dynamic_pointer_cast<StructDecl>(v->type->symbol->decl);
-            int size =std::dynamic_pointer_cast<StructDecl>(v->type->symbol->decl)->size;
-            emit("allocate", symbol_table[v], std::to_string(size));
-        }
-
-        else if (v->type->arraySize.size()){
-            int size = v->type->size;
-            for (int i : v->type->arraySize){
-                size = size * i;
-            }
-            emit("allocate", symbol_table[v], std::to_string(size));
+        // the register holds the address of the object
+        if (in_memory(v)){
+            allocated = true;
+            emit("allocate", symbol_table[v], std::to_string(v->type->size));
         }
     }
 
@@ -182,7 +365,11 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Primary> p) {
             emit("mov", r, p->token->value);
             break;
         case TT::IDENTIFIER: {
-            r = symbol_table[std::dynamic_pointer_cast<VarDecl>(p->symbol->decl)];
+            auto v = std::dynamic_pointer_cast<VarDecl>(p->symbol->decl);
+            if (in_memory(v)){
+                return load(std::make_shared<Address>(symbol_table[v]), p->type);
+            }
+            r = symbol_table[v];
             break;
         }
         default:
@@ -194,93 +381,192 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Primary> p) {
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Return> r) {
 
+    // an inlined body returns to its caller's code, not in tail position
+    auto c = r->expr.has_value() ? std::dynamic_pointer_cast<Call>(*r->expr) : nullptr;
+    if (c && tail_calls && !return_value && tail_call(c)){
+        return NO_REGISTER;
+    }
+
     if (r->expr.has_value()){
-        std::shared_ptr<Register> v = r->expr->get()->accept(*this);
-        emit("mov", Register::get_physical_register("rax"), v);
+        Operand v = operand(*r->expr);
+        if (return_value){
+            emit("mov", return_value, v);
+        }
+        else{
+            emit("mov", Register::get_physical_register("rax"), v);
+        }
     }
 
     emit_branch("jmp", return_label);
     return NO_REGISTER;
 }
 
+// an int literal from 1 to INT_MAX, 0 is left to idiv which traps on it
+bool InstructionGen::constant_divisor(std::shared_ptr<Expr> e, long& divisor) {
+    auto p = std::dynamic_pointer_cast<Primary>(e);
+    if (!p || p->token->token_type != TT::INT_LITERAL){
+        return false;
+    }
+    size_t used = 0;
+    try {
+        divisor = std::stol(p->token->value, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == p->token->value.size() && divisor >= 1 && divisor <= INT_MAX;
+}
+
+/*
+ * Multiplier m and shift s with n / d = (high half of n*m) >> s for every 64-bit n >= 0, from Hacker's
+ * Delight 10-1: 2^p / d rounded up for the smallest p that keeps the error below one. A negative m is
+ * an unsigned multiplier of 64 bits, n is added back to the high half to make up for its sign
+ */
+static std::pair<long, int> magic(long d) {
+    const unsigned long two63 = 1UL << 63;
+    unsigned long divisor = d;
+    unsigned long limit = two63 - 1 - two63 % divisor;
+    unsigned long q1 = two63 / limit;
+    unsigned long r1 = two63 - q1 * limit;
+    unsigned long q2 = two63 / divisor;
+    unsigned long r2 = two63 - q2 * divisor;
+    int p = 63;
+    unsigned long delta;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= limit){
+            q1++;
+            r1 -= limit;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= divisor){
+            q2++;
+            r2 -= divisor;
+        }
+        delta = divisor - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    return {long(q2 + 1), p - 64};
+}
+
+/*
+ * res = res / d, or res % d, rounding toward zero like idiv. A power of two is an arithmetic shift of
+ * res biased by d - 1 when negative, any other d a multiplication by its magic number, with one added
+ * to negative quotients. The remainder is res - quotient * d
+ */
+void InstructionGen::divide(std::shared_ptr<Register> res, long d, bool remainder) {
+    auto rax = Register::get_physical_register("rax");
+    auto rdx = Register::get_physical_register("rdx");
+    if (d == 1){
+        if (remainder){
+            emit("mov", res, "0");
+        }
+        return;
+    }
+
+    if ((d & (d - 1)) == 0){
+        int k = 0;
+        while ((1L << k) != d){
+            k++;
+        }
+        emit("mov", rax, res);
+        emit("sar", rax, "63");
+        emit("shr", rax, std::to_string(64 - k));
+        emit("add", rax, res);
+        if (remainder){
+            emit("and", rax, std::to_string(-d));
+            emit("sub", res, rax);
+        }
+        else{
+            emit("sar", rax, std::to_string(k));
+            emit("mov", res, rax);
+        }
+        return;
+    }
+
+    auto [multiplier, shift] = magic(d);
+    emit("mov", rax, res);
+    emit("mov", rdx, std::to_string(multiplier));
+    emit("imul", rdx);
+    if (multiplier < 0){
+        emit("add", rdx, res);
+    }
+    if (shift){
+        emit("sar", rdx, std::to_string(shift));
+    }
+    emit("mov", rax, res);
+    emit("shr", rax, "63");
+    emit("add", rdx, rax);
+    if (remainder){
+        emit("imul", rdx, std::to_string(d));
+        emit("sub", res, rdx);
+    }
+    else{
+        emit("mov", res, rdx);
+    }
+}
+
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Binary> b) {
+    bool unused = std::exchange(discarded, false);
 
     if (b->op->token_type == TT::ASSIGN){
+        auto p = std::dynamic_pointer_cast<Primary>(b->expr1);
+        auto v = p ? std::dynamic_pointer_cast<VarDecl>(p->symbol->decl) : nullptr;
+        bool in_register = v && !in_memory(v);
+        if (in_register && unused && Selector(*this).assign(symbol_table[v], v, b->expr2)){
+            return symbol_table[v];
+        }
+        // a constant stored as a statement is an immediate, as in a[i] = 0
+        if (unused && !in_register){
+            Operand x = operand(b->expr2, true);
+            store(get_address(b->expr1), x, b->expr1->type);
+            return x.reg;
+        }
         std::shared_ptr<Register> r2 = b->expr2->accept(*this);
-        if (std::dynamic_pointer_cast<Primary>(b->expr1) && std::dynamic_pointer_cast<Primary>(b->expr1)->token->token_type == TT::IDENTIFIER){
-            std::shared_ptr<VirtualRegister> r1 = symbol_table[std::dynamic_pointer_cast<VarDecl>(b->expr1->symbol->decl)];
-            emit("mov", r1, r2);
+        if (in_register){
+            emit("mov", symbol_table[v], r2);
             return r2;
         }
-        std::shared_ptr<Register> r1 = get_address(b->expr1);
-        emit("mov", r1->mem(), r2);
+        store(get_address(b->expr1), r2, b->expr1->type);
         return r2;
     }
 
+    // arithmetic and comparisons go through instruction selection, divisions are left here
+    if (Selector::covers(b)){
+        return Selector(*this).value(b);
+    }
+
     std::shared_ptr<Register> r1 = b->expr1->accept(*this);
-    std::shared_ptr<Register> r2 = b->expr2->accept(*this);
+    // a literal divisor is not materialized, the division becomes a multiplication
+    long divisor = 0;
+    bool by_constant = constant_divisor(b->expr2, divisor);
+    std::shared_ptr<Register> r2 = by_constant ? nullptr : b->expr2->accept(*this);
     std::shared_ptr<Register> res = gen_register();
 
     emit("mov", res, r1);
 
     switch (b->op->token_type) {
-        case TT::PLUS:
-            emit("add", res, r2);
-            break;
-        case TT::MINUS:
-            emit("sub", res, r2);
-            break;
-        case TT::ASTERISK:
-            emit("imul", res, r2);
-            break;
         case TT::DIV:
+            if (by_constant){
+                divide(res, divisor, false);
+                break;
+            }
             emit("mov", Register::get_physical_register("rax"), res);
             emit("cqo");
             emit("idiv", r2);
             emit("mov", res, Register::get_physical_register("rax"));
             break;
         case TT::REM:
+            if (by_constant){
+                divide(res, divisor, true);
+                break;
+            }
             emit("mov", Register::get_physical_register("rax"), res);
             emit("cqo");
             emit("idiv", r2);
             emit("mov", res, Register::get_physical_register("rdx"));
             break;
-        case TT::LE:
-            emit("cmp", res, r2);
-            emit("setle", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::LT:
-            emit("cmp", res, r2);
-            emit("setl", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::GE:
-            emit("cmp", res, r2);
-            emit("setge", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::GT:
-            emit("cmp", res, r2);
-            emit("setg", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::EQ:
-            emit("cmp", res, r2);
-            emit("sete", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::NE:
-            emit("cmp", res, r2);
-            emit("setne", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::LOGOR:
-            emit("or", res, r2);
-            break;
-        case TT::LOGAND:
-            emit("and", res, r2);
-            break;
         default:
             break;
     }
@@ -292,34 +578,17 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Binary> b) {
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Unary> u) {
     if (u->op->token_type == TT::AND){
-        return get_address(u->expr1);
+        return materialize(get_address(u->expr1));
+    }
+    if (Selector::covers(u)){
+        return Selector(*this).value(u);
     }
 
     std::shared_ptr<Register> r = u->expr1->accept(*this);
-    std::shared_ptr<Register> res = gen_register();
-
-    switch (u->op->token_type) {
-        case TT::MINUS:
-            emit("mov", res, r);
-            emit("neg ", res);
-            break;
-        case TT::NOT:
-            emit("mov", res, r);
-            emit("test", res, res);
-            emit("sete", res->copy(1));
-            emit("movzx", res, res->copy(1));
-            break;
-        case TT::ASTERISK:
-            if (u->expr1->type->token->token_type == TT::STRUCT){
-                return res;
-            }
-            emit("mov ", res, r->mem());
-            break;
-        default:
-            break;
+    if (u->op->token_type == TT::ASTERISK){
+        return load(std::make_shared<Address>(r), u->type);
     }
-
-    return res;
+    return r;
 }
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<If> f) {
@@ -331,11 +600,11 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<If> f) {
         emit("cmp", r,"1");
         emit_branch("jne", else_label);
 
-        f->stmt1->accept(*this);
+        statement(f->stmt1);
         emit_branch("jmp", end);
 
         emit_label(else_label, false);
-        f->stmt2->get()->accept(*this);
+        statement(*f->stmt2);
 
         emit_label(end, false);
     }
@@ -345,7 +614,7 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<If> f) {
         std::shared_ptr<Register> r = f->expr1->accept(*this);
         emit("cmp", r, "1");
         emit_branch("jne ", end);
-        f->stmt1->accept(*this);
+        statement(f->stmt1);
         emit_label(end, false);
     }
 
@@ -363,7 +632,7 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<While> w) {
     emit("cmp", r, "1");
     emit_branch("jne", end);
 
-    w->stmt->accept(*this);
+    statement(w->stmt);
 
     emit_branch("jmp", start);
     emit_label(end, false);
@@ -383,17 +652,11 @@ std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Continue>) {
 }
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Member> m) {
-    std::shared_ptr<VirtualRegister> res = gen_register();
-    emit("mov", res, get_address(m)->mem());
-
-    return res;
+    return load(get_address(m), m->type);
 }
 
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<Subscript> s) {
-    std::shared_ptr<VirtualRegister> res = gen_register();
-    emit("mov", res, get_address(s)->mem());
-
-    return res;
+    return load(get_address(s), s->type);
 }
 
 void InstructionGen::emit(std::string opcode, std::shared_ptr<Register> r1, std::shared_ptr<Register> r2){
@@ -413,6 +676,25 @@ void InstructionGen::emit(std::string opcode, std::shared_ptr<Register> r1, std:
     instructions.push_back(i);
 }
 
+void InstructionGen::emit(std::string opcode, std::shared_ptr<Register> r1, const Operand& x){
+    if (x.reg){
+        emit(std::move(opcode), std::move(r1), x.reg);
+    }
+    else{
+        emit(std::move(opcode), std::move(r1), x.imm);
+    }
+}
+
+// push imm32 sign extends to the qword it pushes
+void InstructionGen::emit(std::string opcode, const Operand& x){
+    if (x.reg){
+        emit(std::move(opcode), x.reg);
+        return;
+    }
+    std::shared_ptr<Instruction> i = std::make_shared<BasicInstruction>(opcode, std::vector<std::shared_ptr<Register>>{}, x.imm);
+    instructions.push_back(i);
+}
+
 void InstructionGen::emit(std::string opcode){
     std::vector<std::shared_ptr<Register>> r;
     std::shared_ptr<Instruction> i = std::make_shared<BasicInstruction>(opcode, r);
@@ -436,56 +718,219 @@ void InstructionGen::emit_label(std::string label, bool isFunc) {
 }
 
 std::shared_ptr<VirtualRegister> InstructionGen::gen_register(){
-    return std::make_shared<VirtualRegister>();
+    return std::make_shared<VirtualRegister>(register_id++);
 }
 
+// labels are NASM local labels, scoped to the enclosing function label
 std::string InstructionGen::gen_label(std::string name) {
-    return name + std::to_string(label_id++);
+    return "." + name + std::to_string(label_id++);
 }
 
 /*
- * Returns a register holding the address of the expression
- * It is assumed that virtual register will point to an addressable memory location
+ * Returns the memory operand of the expression
+ * Member offsets, constant indexes and element sizes are folded into [base + index*scale + disp]
+ * so an access is a single instruction
  */
-std::shared_ptr<Register> InstructionGen::get_address(std::shared_ptr<Expr> e) {
+std::shared_ptr<Address> InstructionGen::get_address(std::shared_ptr<Expr> e) {
     if (auto p = std::dynamic_pointer_cast<Primary>(e)) {
-        if ((p->type->token->token_type == TT::STRUCT && p->type->pointerCount == 0)){
-            return symbol_table[std::dynamic_pointer_cast<VarDecl>(p->symbol->decl)];
+        auto v = std::dynamic_pointer_cast<VarDecl>(p->symbol->decl);
+        if (in_memory(v)){
+            return std::make_shared<Address>(symbol_table[v]);
         }
 
-        auto r = symbol_table[std::dynamic_pointer_cast<VarDecl>(p->symbol->decl)];
         std::shared_ptr<Register> res = gen_register();
-        emit("lea", res, r);
-        return res;
+        emit("lea", res, symbol_table[v]);
+        return std::make_shared<Address>(res);
     }
     else if (auto s = std::dynamic_pointer_cast<Subscript>(e)) {
-        std::shared_ptr<Register> base = get_address(s->array);
-        std::shared_ptr<Register> index = s->index->accept(*this);
-        std::shared_ptr<Register> res = gen_register();
-        emit("mov", res, base);
-        emit("imul", index, std::to_string(s->type->size));
-        emit("add", res, index);
-        return res;
+        // an array of arrays keeps adding to the operand of the outer array,
+        // otherwise the value of the array is the address of its first element
+        std::shared_ptr<Address> address;
+        if (s->array->type->is_aggregate()){
+            address = get_address(s->array);
+        }
+        else{
+            address = std::make_shared<Address>(s->array->accept(*this));
+        }
+
+        int size = s->type->size;
+        if (auto i = std::dynamic_pointer_cast<Primary>(s->index); i && i->token->token_type == TT::INT_LITERAL){
+            address->disp += std::stoi(i->token->value) * size;
+            return address;
+        }
+
+        // a constant added to the index, as in a[i + 1], goes to the displacement
+        std::shared_ptr<Register> index = Selector(*this).index(s->index, size, address->disp);
+        if (address->index){
+            address = std::make_shared<Address>(materialize(address));
+        }
+        return scale_index(address, index, size);
     }
     else if (auto m = std::dynamic_pointer_cast<Member>(e)) {
-        std::shared_ptr<Register> base = get_address(m->structure);
-        std::shared_ptr<VirtualRegister> res = gen_register();
-        emit("mov", res, base);
-        emit("add", res, std::to_string(std::dynamic_pointer_cast<VarDecl>(m->symbol->decl)->offset));
-        return res;
+        std::shared_ptr<Address> address = get_address(m->structure);
+        address->disp += std::dynamic_pointer_cast<VarDecl>(m->symbol->decl)->offset;
+        return address;
     }
     else if (auto u = std::dynamic_pointer_cast<Unary>(e)) {
         if(u->op->token_type == TT::ASTERISK) {
-            return u->expr1->accept(*this);
+            return std::make_shared<Address>(u->expr1->accept(*this));
         }
     }
 
     return nullptr;
 }
 
+/*
+ * Adds index*size to the operand, x86 only scales by 1, 2, 4 or 8
+ * Other sizes are k*2^m with k in {3, 5, 9} scaled by one lea, then by a shift or the scale,
+ * imul is left for the remaining ones. The index register itself is never modified
+ */
+std::shared_ptr<Address> InstructionGen::scale_index(std::shared_ptr<Address> address, std::shared_ptr<Register> index, int size) {
+    address->index = index;
+    if (size == 1 || size == 2 || size == 4 || size == 8){
+        address->scale = size;
+        return address;
+    }
+
+    int shift = 0;
+    int k = size;
+    while (k > 1 && k % 2 == 0){
+        k /= 2;
+        shift++;
+    }
+
+    std::shared_ptr<VirtualRegister> scaled = gen_register();
+    if (k == 3 || k == 5 || k == 9 || k == 1){
+        if (k == 1){
+            emit("mov", scaled, index);
+        }
+        else{
+            auto times_k = std::make_shared<Address>(index);
+            times_k->index = index;
+            times_k->scale = k - 1;
+            emit("lea", scaled, times_k);
+        }
+        if (shift > 3){
+            emit("shl", scaled, std::to_string(shift - 3));
+            shift = 3;
+        }
+        address->scale = 1 << shift;
+    }
+    else{
+        emit("mov", scaled, index);
+        emit("imul", scaled, std::to_string(size));
+        address->scale = 1;
+    }
+    address->index = scaled;
+    return address;
+}
+
+// register holding the address, lea only when there is something to add
+std::shared_ptr<Register> InstructionGen::materialize(std::shared_ptr<Address> address) {
+    if (address->is_register()){
+        return address->base;
+    }
+
+    std::shared_ptr<VirtualRegister> res = gen_register();
+    emit("lea", res, address);
+    return res;
+}
+
+bool InstructionGen::in_memory(std::shared_ptr<VarDecl> v) {
+    return v->type->is_aggregate() || v->address_taken;
+}
+
+/*
+ * Value of the object of the given type at address
+ * chars and ints are sign extended to the full register, aggregates are used through their address
+ */
+std::shared_ptr<Register> InstructionGen::load(std::shared_ptr<Address> address, std::shared_ptr<Type> type) {
+    if (type->is_aggregate()){
+        return materialize(address);
+    }
+
+    std::shared_ptr<VirtualRegister> res = gen_register();
+    switch (type->size) {
+        case 1:
+            emit("movsx", res, address->sized(1));
+            break;
+        case 4:
+            emit("movsxd", res, address->sized(4));
+            break;
+        default:
+            emit("mov", res, address->sized(8));
+            break;
+    }
+    return res;
+}
+
+// stores the low type->size bytes of value, a struct value is copied
+void InstructionGen::store(std::shared_ptr<Address> address, const Operand& value, std::shared_ptr<Type> type) {
+    if (type->is_aggregate()){
+        copy(materialize(address), value.reg, type->size);
+        return;
+    }
+
+    int size = type->size == 1 || type->size == 4 ? type->size : 8;
+    if (value.reg){
+        emit("mov", address->sized(size), value.reg->copy(size));
+    }
+    else{
+        emit("mov", address->sized(size), value.imm);
+    }
+}
+
+InstructionGen::Operand InstructionGen::operand(std::shared_ptr<Expr> e, bool stored) {
+    Selector selector(*this);
+    long value;
+    if (selector.constant(e, value)){
+        return Operand(std::to_string(value));
+    }
+    return Selector::covers(e) ? selector.value(e, stored) : e->accept(*this);
+}
+
+/*
+ * Up to 64 bytes are moved through xmm15 16 bytes at a time, then through a register, which leaves the
+ * argument registers alone. Larger objects use rep movs, which clobbers rsi, rdi and rcx
+ */
+void InstructionGen::copy(std::shared_ptr<Register> dest, std::shared_ptr<Register> src, int size) {
+    if (size <= 64){
+        std::shared_ptr<VirtualRegister> value;
+        int offset = 0;
+        for (int width : {16, 8, 4, 2, 1}){
+            for (; size - offset >= width; offset += width){
+                auto from = std::make_shared<Address>(src);
+                auto to = std::make_shared<Address>(dest);
+                from->disp = to->disp = offset;
+                if (width == 16){
+                    emit("movdqu", Register::get_physical_register("xmm15"), from->sized(16));
+                    emit("movdqu", to->sized(16), Register::get_physical_register("xmm15"));
+                    continue;
+                }
+                value = value ? value : gen_register();
+                emit("mov", value->copy(width), from->sized(width));
+                emit("mov", to->sized(width), value->copy(width));
+            }
+        }
+        return;
+    }
+
+    emit("mov", Register::get_physical_register("rsi"), src);
+    emit("mov", Register::get_physical_register("rdi"), dest);
+    emit("cld");
+    if (size % 8 == 0){
+        emit("mov", Register::get_physical_register("rcx"), std::to_string(size / 8));
+        emit("rep movsq");
+    }
+    else{
+        emit("mov", Register::get_physical_register("rcx"), std::to_string(size));
+        emit("rep movsb");
+    }
+}
+
 std::shared_ptr<Register> InstructionGen::visit(std::shared_ptr<TypeCast> typeCast) {
     std::shared_ptr<VirtualRegister> res = gen_register();
-    emit("mov", res, typeCast->expr1->accept(*this));
+    emit("mov", res, operand(typeCast->expr1));
     return res;
 }
 
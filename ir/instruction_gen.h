@@ -8,6 +8,7 @@
 
 #include "../parser/ast.h"
 #include "ir.h"
+#include "inliner.h"
 
 class InstructionGen : public Visitor<std::shared_ptr<Register>>{
 public:
@@ -16,23 +17,74 @@ public:
     std::shared_ptr<VirtualRegister> NO_REGISTER = nullptr;
 
     int label_id = 0;
+    int register_id = 0;
     std::string return_label = "";
+    // where a return puts its value while an inlined body is generated, rax otherwise
+    std::shared_ptr<VirtualRegister> return_value = nullptr;
+    // null when no call is inlined
+    const Inliner* inliner = nullptr;
+
+    // a call in tail position jumps to the callee, or back to tail_label when it is the function itself.
+    // Turned off and the function generated again when one of its objects lives in the frame
+    std::shared_ptr<FuncDecl> function;
+    std::string tail_label;
+    bool tail_calls = true;
+    bool tail_called = false;
+    bool allocated = false;
     std::vector<std::pair<std::string,std::string>> loop_labels;
+    // the value of the expression statement being generated is not used
+    bool discarded = false;
 
     std::unordered_map<std::shared_ptr<VarDecl>, std::shared_ptr<VirtualRegister>> symbol_table;
     std::vector<std::string> arg_reg_order = {"rdi", "rsi", "rdx", "rcx", "r8", "r9"};
 
+    // source operand of an instruction, a register or an imm32 when reg is null
+    struct Operand {
+        std::shared_ptr<Register> reg;
+        std::string imm;
+
+        Operand(std::shared_ptr<Register> reg) : reg(std::move(reg)) {}
+        explicit Operand(std::string imm) : imm(std::move(imm)) {}
+    };
+
     void emit(std::string opcode, std::shared_ptr<Register> r1, std::shared_ptr<Register> r2);
     void emit(std::string opcode, std::shared_ptr<Register> r1);
     void emit(std::string opcode, std::shared_ptr<Register> r1, std::string value);
+    void emit(std::string opcode, std::shared_ptr<Register> r1, const Operand& x);
+    void emit(std::string opcode, const Operand& x);
     void emit(std::string opcode);
     void emit_branch(std::string opcode, std::string label);
     void emit_branch(std::string opcode, std::shared_ptr<Register> r1);
     void emit_label(std::string label, bool isFunc);
+    void statement(std::shared_ptr<Stmt> s);
 
     std::shared_ptr<VirtualRegister> gen_register();
     std::string gen_label(std::string name);
-    std::shared_ptr<Register> get_address(std::shared_ptr<Expr> e);
+    std::shared_ptr<Address> get_address(std::shared_ptr<Expr> e);
+    std::shared_ptr<Address> scale_index(std::shared_ptr<Address> address, std::shared_ptr<Register> index, int size);
+    std::shared_ptr<Register> materialize(std::shared_ptr<Address> address);
+
+    // where an argument is passed: count registers from arg_reg_order[reg], the stack when count is 0
+    struct ArgLocation {
+        int reg = 0;
+        int count = 0;
+        // the bytes of a struct rather than its address
+        bool by_value = false;
+    };
+    std::vector<ArgLocation> classify(const std::vector<std::shared_ptr<Type>>& types);
+    void set_arg_registers(const std::vector<Operand>& args, const std::vector<ArgLocation>& locations);
+
+    bool in_memory(std::shared_ptr<VarDecl> v);
+    std::shared_ptr<Register> inline_call(std::shared_ptr<Call> c, std::shared_ptr<FuncDecl> f);
+    bool tail_call(std::shared_ptr<Call> c);
+    std::shared_ptr<Register> load(std::shared_ptr<Address> address, std::shared_ptr<Type> type);
+    void store(std::shared_ptr<Address> address, const Operand& value, std::shared_ptr<Type> type);
+    // the value of e, a literal or constant arithmetic fitting an imm32 is not materialized. A stored
+    // value is only exact in the bytes stored
+    Operand operand(std::shared_ptr<Expr> e, bool stored = false);
+    void copy(std::shared_ptr<Register> dest, std::shared_ptr<Register> src, int size);
+    bool constant_divisor(std::shared_ptr<Expr> e, long& divisor);
+    void divide(std::shared_ptr<Register> res, long d, bool remainder);
 
     std::shared_ptr<Register> visit(std::shared_ptr<Program>) override;
     std::shared_ptr<Register> visit(std::shared_ptr<FuncDecl>) override;
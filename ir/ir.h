@@ -27,6 +27,8 @@ public:
     Register(std::string name, std::string name_d, std::string name_w, std::string name_b, int size, bool virt, bool mem)
             : name(name), name_d(name_d), name_w(name_w), name_b(name_b), size(size), isVirtual(virt), isMemoryOperand(mem) {}
 
+    virtual ~Register() = default;
+
     std::shared_ptr<Register> copy(int size){
         return std::make_shared<Register>(name, name_d, name_w, name_b, size, isVirtual, isMemoryOperand);
     }
@@ -36,21 +38,24 @@ public:
     }
 
 
-    static std::vector<std::shared_ptr<Register>> registers;
+    // Physical register table, shared read-only by every compilation.
+    // Lookups hand out copies so no Register object is shared between threads.
+    static const std::vector<std::shared_ptr<const Register>> registers;
 
     static std::shared_ptr<Register> get_physical_register(std::string name){
-        for (auto r : registers){
+        for (auto& r : registers){
             if (r->name == name){
-                return r;
+                return std::make_shared<Register>(*r);
             }
         }
         return nullptr;
     }
 
     static std::shared_ptr<Register> get_physical_register(std::string name, int size, bool mem){
-        for (auto r : registers){
+        for (auto& r : registers){
             if (r->name == name){
-                auto res = r->copy(size);
+                auto res = std::make_shared<Register>(*r);
+                res->size = size;
                 res->isMemoryOperand = mem;
                 return res;
             }
@@ -58,18 +63,50 @@ public:
         return nullptr;
     }
 
+    // xmm<n>, or ymm<n> when width is 32, the vectorizer assigns these itself
+    static std::shared_ptr<Register> vector_register(int n, int width){
+        std::string name = (width == 32 ? "ymm" : "xmm") + std::to_string(n);
+        return std::make_shared<Register>(name, name, name, name, width, false, false);
+    }
+
 };
 
 class VirtualRegister : public Register{
 public:
-    static int count;
-
-    VirtualRegister() : Register(std::to_string(count++), "", "", "") {
+    // ids are handed out by the InstructionGen that owns the compilation
+    VirtualRegister(int id) : Register(std::to_string(id), "", "", "") {
         isVirtual = true;
     }
 
 };
 
+/*
+ * x86 memory operand [base + index*scale + disp], size is the width of the access
+ * base and index are registers of their own, the allocator rewrites them like any other operand
+ */
+class Address : public Register {
+public:
+    std::shared_ptr<Register> base;
+    std::shared_ptr<Register> index;
+    int scale = 1;
+    int disp = 0;
+
+    explicit Address(std::shared_ptr<Register> base) : Register("", "", "", ""), base(std::move(base)) {
+        isMemoryOperand = true;
+    }
+
+    std::shared_ptr<Address> sized(int width){
+        auto a = std::make_shared<Address>(*this);
+        a->size = width;
+        return a;
+    }
+
+    // the address is just a register, no lea needed to compute it
+    bool is_register() const {
+        return !index && disp == 0;
+    }
+};
+
 class CodeGen;
 
 class Instruction {
@@ -6,9 +6,14 @@
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <sstream>
 
 class IRPrinter {
 public:
+    static std::string name(const std::shared_ptr<Register>& reg) {
+        return (reg->isVirtual ? "%" : "") + reg->name;
+    }
+
     static void print(const std::vector<std::shared_ptr<Instruction>>& ir, const std::string& filename) {
         std::ofstream outFile(filename);
 
@@ -17,50 +22,68 @@ public:
             return;
         }
 
+        print(ir, outFile);
+    }
+
+    static std::string str(const std::vector<std::shared_ptr<Instruction>>& ir) {
+        std::ostringstream out;
+        print(ir, out);
+        return out.str();
+    }
+
+    static void print(const std::vector<std::shared_ptr<Instruction>>& ir, std::ostream& outFile) {
         bool lastWasLabel = false;
 
         for (const auto& instr : ir) {
             if (auto basic = std::dynamic_pointer_cast<BasicInstruction>(instr)) {
                 if (basic->opcode == "emit_asm") {
-                    outFile << "\t" << basic->value << std::endl;
+                    outFile << "\t" << basic->value << "\n";
                 } else {
                     outFile << "\t" << basic->opcode;
                     for (const auto& reg : basic->registers) {
-                        if (reg->isMemoryOperand) {
+                        if (auto a = std::dynamic_pointer_cast<Address>(reg)) {
+                            outFile << (a->size == 1 ? " byte" : a->size == 4 ? " dword" : "") << " [" << name(a->base);
+                            if (a->index) {
+                                outFile << " + " << name(a->index) << "*" << a->scale;
+                            }
+                            if (a->disp) {
+                                outFile << " + " << a->disp;
+                            }
+                            outFile << "]";
+                        } else if (reg->isMemoryOperand) {
+                            outFile << (reg->size == 1 ? " byte" : reg->size == 4 ? " dword" : "");
                             outFile << " [" << (reg->isVirtual ? "%" : "") << reg->name << "]";
                         } else {
                             outFile << " " << (reg->isVirtual ? "%" : "") << reg->name;
                         }
                     }
                     if (!basic->value.empty()) {
-                        outFile << ", " << basic->value;
+                        outFile << (basic->registers.empty() ? " " : ", ") << basic->value;
                     }
-                    outFile << std::endl;
+                    outFile << "\n";
                 }
                 lastWasLabel = false;
             } else if (auto branch = std::dynamic_pointer_cast<BranchInstruction>(instr)) {
-                outFile << "\t" << branch->opcode << " " << branch->label << std::endl;
+                outFile << "\t" << branch->opcode << " " << branch->label << "\n";
                 lastWasLabel = false;
             } else if (auto label = std::dynamic_pointer_cast<Label>(instr)) {
                 if (label->funcDecl && !lastWasLabel) {
-                    outFile << std::endl;
+                    outFile << "\n";
                 }
-                outFile << label->label << ":" << std::endl;
+                outFile << label->label << ":" << "\n";
                 lastWasLabel = true;
             } else if (auto global = std::dynamic_pointer_cast<GlobalVariable>(instr)) {
                 outFile << "\t" << global->directive << " " << global->label;
                 if (!global->value.empty()) {
                     outFile << " " << global->value;
                 }
-                outFile << " (size: " << global->size << ")" << std::endl;
+                outFile << " (size: " << global->size << ")" << "\n";
                 lastWasLabel = false;
             } else {
-                outFile << "\tUNKNOWN INSTRUCTION" << std::endl;
+                outFile << "\tUNKNOWN INSTRUCTION" << "\n";
                 lastWasLabel = false;
             }
         }
-
-        outFile.close();
     }
 };
 
@@ -0,0 +1,55 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#include "ir_verifier.h"
+#include <stdexcept>
+#include <unordered_set>
+
+static void fail(const std::string& function, const std::string& after, size_t index, const std::string& message) {
+    throw std::logic_error("IR verification failed in " + function + " after " + after + ", instruction " +
+                           std::to_string(index) + ": " + message);
+}
+
+void IRVerifier::verify(const std::vector<std::shared_ptr<Instruction>>& instructions, const std::string& function, const std::string& after) {
+    std::unordered_set<std::string> labels;
+    for (size_t k = 0; k < instructions.size(); k++){
+        if (auto label = std::dynamic_pointer_cast<Label>(instructions[k])){
+            if (!labels.insert(label->label).second){
+                fail(function, after, k, "label " + label->label + " defined twice");
+            }
+        }
+    }
+
+    for (size_t k = 0; k < instructions.size(); k++){
+        const std::shared_ptr<Instruction>& i = instructions[k];
+        if (!i){
+            fail(function, after, k, "null instruction");
+        }
+        if (i->opcode.empty()){
+            fail(function, after, k, "empty opcode");
+        }
+
+        for (auto& r : i->registers){
+            if (!r){
+                fail(function, after, k, i->opcode + " has a null operand");
+            }
+            if (auto a = std::dynamic_pointer_cast<Address>(r)){
+                if (!a->base){
+                    fail(function, after, k, i->opcode + " has an address without a base");
+                }
+                if (a->index && a->scale != 1 && a->scale != 2 && a->scale != 4 && a->scale != 8){
+                    fail(function, after, k, i->opcode + " has an index scale of " + std::to_string(a->scale));
+                }
+            }
+        }
+
+        // calls, returns, register jumps and tail calls (to a function, local labels start with '.') leave the
+        // function, every other branch stays in it
+        auto branch = std::dynamic_pointer_cast<BranchInstruction>(i);
+        if (branch && branch->registers.empty() && i->opcode.rfind("call", 0) != 0 && i->opcode != "ret"
+            && branch->label.rfind(".", 0) == 0 && !labels.count(branch->label)){
+            fail(function, after, k, i->opcode + " to undefined label " + branch->label);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#ifndef COMPILER_IR_VERIFIER_H
+#define COMPILER_IR_VERIFIER_H
+
+#include <string>
+#include "ir.h"
+
+/*
+ * Structural checks of one function's IR, run after every pass in debug builds:
+ * operands are present, addresses are well formed, labels are unique and every jump
+ * targets a label of the function. Throws std::logic_error naming the pass to blame
+ */
+class IRVerifier {
+public:
+    static void verify(const std::vector<std::shared_ptr<Instruction>>& instructions, const std::string& function, const std::string& after);
+};
+
+#endif //COMPILER_IR_VERIFIER_H
@@ -0,0 +1,171 @@
+//
+// Created by Ryan Senoune on 2025-03-17.
+//
+
+#include "licm.h"
+#include <unordered_set>
+
+// computes a virtual register from immediates and other virtual registers, without memory accesses
+static bool movable(const std::shared_ptr<Instruction>& i) {
+    static const std::unordered_set<std::string> opcodes = {"mov", "lea", "movzx", "movsx", "movsxd", "add", "sub", "imul",
+                                                            "shl", "and", "or", "xor", "neg"};
+    auto basic = std::dynamic_pointer_cast<BasicInstruction>(i);
+    std::string opcode = CFG::trimmed(i->opcode);
+    if (!basic || !opcodes.count(opcode) || i->registers.empty() || i->registers.size() > 2 || !Operands::virtual_register(i->registers[0])){
+        return false;
+    }
+    if (i->registers.size() == 1){
+        return opcode == "neg" || !basic->value.empty();
+    }
+    if (auto a = std::dynamic_pointer_cast<Address>(i->registers[1])){
+        return opcode == "lea" && (!a->base || a->base->isVirtual) && (!a->index || a->index->isVirtual);
+    }
+    return Operands::virtual_register(i->registers[1]) && basic->value.empty();
+}
+
+// instructions that can move in front of the loop, in order
+static std::vector<size_t> hoist(const std::vector<std::shared_ptr<Instruction>>& instructions, const Operands& operands, const CFG& cfg,
+                                 const Loop& loop);
+
+bool LoopInvariantCodeMotion::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    CFG cfg = CFG::build(instructions);
+    Operands operands(instructions);
+    LoopInfo info(cfg);
+    std::vector<int> order = info.innermost_first();
+    bool changed = false;
+    size_t next = 0;
+    while (next < order.size()){
+        std::vector<size_t> hoisted = hoist(instructions, operands, cfg, info.loops[order[next++]]);
+        if (hoisted.empty()){
+            continue;
+        }
+        changed = true;
+
+        // the hoisted code ends the block falling into the header
+        const Loop& loop = info.loops[order[next - 1]];
+        std::vector<bool> moving(instructions.size(), false);
+        for (size_t k : hoisted){
+            moving[k] = true;
+        }
+        std::vector<size_t> moved;
+        std::vector<int> blocks;
+        moved.reserve(instructions.size());
+        blocks.reserve(instructions.size());
+        for (size_t k = 0; k < instructions.size(); k++){
+            if (k == cfg.blocks[loop.header]->begin){
+                moved.insert(moved.end(), hoisted.begin(), hoisted.end());
+                blocks.insert(blocks.end(), hoisted.size(), loop.header - 1);
+            }
+            if (!moving[k]){
+                moved.push_back(k);
+                blocks.push_back(cfg.block_of[k]);
+            }
+        }
+        std::vector<std::shared_ptr<Instruction>> result;
+        result.reserve(moved.size());
+        for (size_t k : moved){
+            result.push_back(instructions[k]);
+        }
+        instructions = std::move(result);
+        operands.reorder(moved);
+
+        // a block holding nothing but hoisted code is gone, renumbering blocks and loops
+        if (!cfg.relocate(instructions, blocks)){
+            cfg = CFG::build(instructions);
+            info = LoopInfo(cfg);
+            order = info.innermost_first();
+            next = 0;
+        }
+    }
+    return changed;
+}
+
+static std::vector<size_t> hoist(const std::vector<std::shared_ptr<Instruction>>& instructions, const Operands& operands, const CFG& cfg,
+                                 const Loop& loop) {
+    if (LoopInfo::preheader(cfg, loop) == -1){
+        return {};
+    }
+
+    std::vector<bool> inside(instructions.size(), false);
+    for (int b : loop.blocks){
+        for (size_t k = cfg.blocks[b]->begin; k < cfg.blocks[b]->end; k++){
+            inside[k] = true;
+        }
+    }
+
+    // first and last assignment of every register in the loop, and the block holding them, -2 for several
+    const long none = -1;
+    std::vector<long> first(operands.count, none);
+    std::vector<long> last(operands.count, none);
+    std::vector<int> block(operands.count, -1);
+    std::vector<bool> outside(operands.count, false);
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        if (!inside[k]){
+            for (int m : operands.mentioned[k]){
+                outside[m] = true;
+            }
+        }
+        else if (r != -1){
+            if (first[r] == none){
+                first[r] = long(k);
+                block[r] = cfg.block_of[k];
+            }
+            else if (block[r] != cfg.block_of[k]){
+                block[r] = -2;
+            }
+            last[r] = long(k);
+        }
+    }
+
+    // a source is invariant when the loop never assigns it, or all its assignments are hoisted before this one
+    std::vector<bool> hoisted(operands.count, false);
+    auto invariant = [&](int r, long at) {
+        return first[r] == none || (hoisted[r] && last[r] < at);
+    };
+    auto hoistable = [&](int r) {
+        if (!operands.overwrites[first[r]]){
+            return false;
+        }
+        // nothing else in the block may see the register before its last assignment
+        for (size_t k = cfg.blocks[block[r]]->begin; long(k) <= last[r]; k++){
+            if (!operands.mentions(k, r)){
+                continue;
+            }
+            if (operands.assigned[k] != r || !movable(instructions[k]) || (k + 1 < instructions.size() && Operands::reads_flags(instructions[k + 1]))){
+                return false;
+            }
+            for (int source : operands.mentioned[k]){
+                if (source != r && !invariant(source, first[r])){
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    std::vector<int> candidates;
+    for (int r = 0; r < operands.count; r++){
+        if (!outside[r] && block[r] >= 0){
+            candidates.push_back(r);
+        }
+    }
+    bool grew = true;
+    while (grew){
+        grew = false;
+        for (int r : candidates){
+            if (!hoisted[r] && hoistable(r)){
+                hoisted[r] = grew = true;
+            }
+        }
+    }
+
+    std::vector<size_t> moved;
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        if (inside[k] && r != -1 && hoisted[r]){
+            moved.push_back(k);
+        }
+    }
+    return moved;
+}
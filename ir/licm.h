@@ -0,0 +1,26 @@
+//
+// Created by Ryan Senoune on 2025-03-17.
+//
+
+#ifndef COMPILER_LICM_H
+#define COMPILER_LICM_H
+
+#include "pass.h"
+#include "dataflow.h"
+#include "loop_info.h"
+
+/*
+ * Loop invariant code motion, innermost loops first
+ *
+ * An instruction moves in front of the loop header when it cannot trap, reads no memory, and computes
+ * a virtual register only used inside the loop from immediates and registers the loop never assigns.
+ * All assignments of the register move together, they must be in one block before any other use of it.
+ * Hoisted code runs even when the loop does not, which is harmless since nothing outside reads it.
+ * Loops that are entered other than by falling into the header have no preheader and are skipped.
+ */
+class LoopInvariantCodeMotion : public Pass {
+public:
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+};
+
+#endif //COMPILER_LICM_H
@@ -0,0 +1,124 @@
+//
+// Created by Ryan Senoune on 2025-03-17.
+//
+
+#include "loop_info.h"
+#include <algorithm>
+
+LoopInfo::LoopInfo(const CFG& cfg) : loop_of(cfg.block_count, -1) {
+    std::vector<int> loop_at(cfg.block_count, -1);
+    for (auto& block : cfg.blocks){
+        for (int header : block->successors){
+            if (!cfg.dominates(header, block->id)){
+                continue;
+            }
+            if (loop_at[header] == -1){
+                loop_at[header] = int(loops.size());
+                loops.emplace_back(header);
+                loops.back().blocks.push_back(header);
+            }
+
+            // walk predecessors back from the latch until the header
+            Loop& loop = loops[loop_at[header]];
+            std::vector<bool> in(cfg.block_count, false);
+            for (int b : loop.blocks){
+                in[b] = true;
+            }
+            std::vector<int> work;
+            if (!in[block->id]){
+                in[block->id] = true;
+                loop.blocks.push_back(block->id);
+                work.push_back(block->id);
+            }
+            while (!work.empty()){
+                int b = work.back();
+                work.pop_back();
+                for (int p : cfg.blocks[b]->predecessors){
+                    if (!in[p] && cfg.idom[p] != -1){
+                        in[p] = true;
+                        loop.blocks.push_back(p);
+                        work.push_back(p);
+                    }
+                }
+            }
+        }
+    }
+
+    for (auto& loop : loops){
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+    }
+
+    // the parent is the smallest other loop containing the header
+    for (size_t l = 0; l < loops.size(); l++){
+        for (size_t o = 0; o < loops.size(); o++){
+            if (o == l || loops[o].blocks.size() <= loops[l].blocks.size() || !loops[o].contains(loops[l].header)){
+                continue;
+            }
+            int& parent = loops[l].parent;
+            if (parent == -1 || loops[o].blocks.size() < loops[parent].blocks.size()){
+                parent = int(o);
+            }
+        }
+    }
+    for (size_t l = 0; l < loops.size(); l++){
+        if (loops[l].parent != -1){
+            loops[loops[l].parent].children.push_back(int(l));
+        }
+    }
+
+    for (int l : innermost_first()){
+        int depth = 1;
+        for (int p = loops[l].parent; p != -1; p = loops[p].parent){
+            depth++;
+        }
+        loops[l].depth = depth;
+        for (int b : loops[l].blocks){
+            if (loop_of[b] == -1 || loops[loop_of[b]].blocks.size() > loops[l].blocks.size()){
+                loop_of[b] = l;
+            }
+        }
+    }
+}
+
+std::vector<int> LoopInfo::innermost_first() const {
+    std::vector<int> order;
+    // post order of the nest tree
+    for (size_t root = 0; root < loops.size(); root++){
+        if (loops[root].parent != -1){
+            continue;
+        }
+        std::vector<std::pair<int, size_t>> stack = {{int(root), 0}};
+        while (!stack.empty()){
+            auto& [l, next] = stack.back();
+            if (next < loops[l].children.size()){
+                int child = loops[l].children[next++];
+                stack.push_back({child, 0});
+                continue;
+            }
+            order.push_back(l);
+            stack.pop_back();
+        }
+    }
+    return order;
+}
+
+int LoopInfo::preheader(const CFG& cfg, const Loop& loop) {
+    auto& header = cfg.blocks[loop.header];
+    auto label = std::dynamic_pointer_cast<Label>(header->instructions.front());
+    int before = loop.header - 1;
+    if (!label || label->funcDecl || before < 0 || loop.contains(before)){
+        return -1;
+    }
+    bool entered = false;
+    for (int p : header->predecessors){
+        if (loop.contains(p)){
+            continue;
+        }
+        auto branch = std::dynamic_pointer_cast<BranchInstruction>(cfg.blocks[p]->instructions.back());
+        if (p != before || (branch && branch->label == label->label)){
+            return -1;
+        }
+        entered = true;
+    }
+    return entered ? before : -1;
+}
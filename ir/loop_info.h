@@ -0,0 +1,48 @@
+//
+// Created by Ryan Senoune on 2025-03-17.
+//
+
+#ifndef COMPILER_LOOP_INFO_H
+#define COMPILER_LOOP_INFO_H
+
+#include <algorithm>
+#include "cfg_gen.h"
+
+class Loop {
+public:
+    int header;
+    // sorted block ids, the header included
+    std::vector<int> blocks;
+    // enclosing loop, -1 for an outermost one
+    int parent = -1;
+    std::vector<int> children;
+    int depth = 1;
+
+    Loop(int header) : header(header) {}
+
+    bool contains(int block) const {
+        return std::binary_search(blocks.begin(), blocks.end(), block);
+    }
+};
+
+/*
+ * Natural loops of a CFG and their nesting
+ * An edge to a block dominating its source is a back edge, the loop of a header is every block
+ * reaching one of its back edges without passing the header. Loops sharing a header are one loop.
+ */
+class LoopInfo {
+public:
+    std::vector<Loop> loops;
+    // innermost loop of every block, -1 outside of loops
+    std::vector<int> loop_of;
+
+    explicit LoopInfo(const CFG& cfg);
+
+    // loop ids, inner loops before the loops containing them
+    std::vector<int> innermost_first() const;
+
+    // block falling into the header, whose end is the only way into the loop, -1 if there is none
+    static int preheader(const CFG& cfg, const Loop& loop);
+};
+
+#endif //COMPILER_LOOP_INFO_H
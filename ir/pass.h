@@ -0,0 +1,23 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#ifndef COMPILER_PASS_H
+#define COMPILER_PASS_H
+
+#include "ir.h"
+
+/*
+ * A transformation of one function's IR, before register allocation
+ * A pass object is created for every function it runs on, so it may keep state
+ * but must not share any between functions, which are compiled in parallel
+ */
+class Pass {
+public:
+    virtual ~Pass() = default;
+
+    // returns whether the instructions changed
+    virtual bool run(std::vector<std::shared_ptr<Instruction>>& instructions) = 0;
+};
+
+#endif //COMPILER_PASS_H
@@ -0,0 +1,126 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#include "pass_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include "gvn.h"
+#include "ir_verifier.h"
+#include "licm.h"
+#include "peephole.h"
+#include "strength_reduction.h"
+#include "vectorizer.h"
+
+template <typename T>
+static std::function<std::unique_ptr<Pass>(const Target&)> factory() {
+    return [](const Target&) { return std::make_unique<T>(); };
+}
+
+template <typename T>
+static std::function<std::unique_ptr<Pass>(const Target&)> targeted() {
+    return [](const Target& target) { return std::make_unique<T>(target); };
+}
+
+// every pass usable in -passes=, in the order -O presets run them
+static const std::vector<std::pair<std::string, std::function<std::unique_ptr<Pass>(const Target&)>>>& registry() {
+    static const std::vector<std::pair<std::string, std::function<std::unique_ptr<Pass>(const Target&)>>> passes = {
+            {"branch-fusion", factory<BranchFusion>()},
+            {"jump-cleanup", factory<JumpCleanup>()},
+            {"licm", factory<LoopInvariantCodeMotion>()},
+            {"loop-vectorize", targeted<LoopVectorizer>()},
+            {"strength-reduction", factory<StrengthReduction>()},
+            {"gvn", factory<GlobalValueNumbering>()},
+    };
+    return passes;
+}
+
+// -O0 keeps the IR exactly as generated, each level runs everything of the level below
+std::vector<std::string> PassManager::preset(int level) {
+    std::vector<std::string> passes;
+    if (level >= 1){
+        passes.insert(passes.end(), {"branch-fusion", "jump-cleanup"});
+    }
+    if (level >= 2){
+        passes.push_back("licm");
+        passes.push_back("loop-vectorize");
+        passes.push_back("strength-reduction");
+        passes.push_back("gvn");
+    }
+    return passes;
+}
+
+std::vector<std::string> PassManager::available() {
+    std::vector<std::string> names;
+    for (auto& [name, f] : registry()){
+        names.push_back(name);
+    }
+    return names;
+}
+
+PassManager::PassManager(std::vector<std::string> pipeline, Target target)
+        : names(std::move(pipeline)), target(std::move(target)), statistics(names.size()) {
+    for (auto& name : names){
+        auto it = std::find_if(registry().begin(), registry().end(), [&](auto& p) { return p.first == name; });
+        if (it == registry().end()){
+            std::string known;
+            for (auto& n : available()){
+                known += (known.empty() ? "" : ", ") + n;
+            }
+            throw std::invalid_argument("Unknown pass '" + name + "', available passes are " + known);
+        }
+        factories.push_back(it->second);
+    }
+}
+
+void PassManager::run(std::vector<std::shared_ptr<Instruction>>& instructions, const std::string& function, TimeProfiler* profiler,
+                      const std::function<void(const std::string&)>& after_pass) {
+    for (size_t p = 0; p < names.size(); p++){
+        long before = instructions.size();
+        auto start = std::chrono::steady_clock::now();
+        bool changed;
+        {
+            TimeProfiler::Scope scope(profiler, names[p], function);
+            changed = factories[p](target)->run(instructions);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+#ifndef NDEBUG
+        IRVerifier::verify(instructions, function, names[p]);
+#endif
+        if (after_pass){
+            after_pass(names[p]);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Statistics& s = statistics[p];
+        s.runs++;
+        s.changed += changed;
+        s.seconds += seconds;
+        s.before += before;
+        s.after += instructions.size();
+    }
+}
+
+std::string PassManager::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string out;
+    char line[160];
+    snprintf(line, sizeof(line), "%-16s %7s %7s %11s %12s %12s %8s\n", "pass", "runs", "changed", "ms", "before", "after", "delta");
+    out += line;
+    for (size_t p = 0; p < names.size(); p++){
+        const Statistics& s = statistics[p];
+        snprintf(line, sizeof(line), "%-16s %7d %7d %11.3f %12ld %12ld %+8ld\n", names[p].c_str(), s.runs, s.changed, s.seconds * 1000,
+                 s.before, s.after, s.after - s.before);
+        out += line;
+    }
+    return out;
+}
+
+void PassManager::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.assign(names.size(), Statistics());
+}
@@ -0,0 +1,60 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#ifndef COMPILER_PASS_MANAGER_H
+#define COMPILER_PASS_MANAGER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pass.h"
+#include "target.h"
+#include "../util/time_profiler.h"
+
+/*
+ * Runs a pipeline of named IR passes over each function
+ *
+ * Passes are registered by name in pass_manager.cpp, a pipeline is either an -O level preset or an
+ * explicit -passes= list, passes depending on the instruction set are created for the -march= target.
+ * Debug builds verify the IR after every pass. Every run adds to per-pass statistics (time and
+ * instruction count before and after), shared by all functions and threads.
+ */
+class PassManager {
+public:
+    // throws std::invalid_argument on an unknown pass name
+    explicit PassManager(std::vector<std::string> pipeline, Target target = Target());
+
+    static std::vector<std::string> preset(int level);
+    static std::vector<std::string> available();
+
+    const std::vector<std::string>& pipeline() const {
+        return names;
+    }
+
+    // after_pass sees the IR as each pass left it, for -dump-ir
+    void run(std::vector<std::shared_ptr<Instruction>>& instructions, const std::string& function, TimeProfiler* profiler = nullptr,
+             const std::function<void(const std::string&)>& after_pass = nullptr);
+
+    // one line per pass in pipeline order, for -time-report
+    std::string report() const;
+    void clear();
+
+private:
+    struct Statistics {
+        int runs = 0;
+        int changed = 0;
+        double seconds = 0;
+        long before = 0;
+        long after = 0;
+    };
+
+    std::vector<std::string> names;
+    Target target;
+    std::vector<std::function<std::unique_ptr<Pass>(const Target&)>> factories;
+    mutable std::mutex mutex;
+    std::vector<Statistics> statistics;
+};
+
+#endif //COMPILER_PASS_MANAGER_H
@@ -0,0 +1,133 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#include "peephole.h"
+#include <unordered_map>
+
+// opcodes are emitted with trailing spaces in places, "jne " is a jne
+static std::string trimmed(const std::string& opcode) {
+    return opcode.substr(0, opcode.find_last_not_of(' ') + 1);
+}
+
+std::string BranchFusion::inverse_jump(const std::string& set) {
+    static const std::unordered_map<std::string, std::string> inverse = {
+            {"sete", "jne"}, {"setne", "je"}, {"setl", "jge"}, {"setge", "jl"}, {"setg", "jle"}, {"setle", "jg"}};
+    auto it = inverse.find(trimmed(set));
+    return it == inverse.end() ? "" : it->second;
+}
+
+static bool is_register(const std::shared_ptr<Instruction>& i, size_t k, const std::string& name) {
+    return i->registers.size() > k && i->registers[k]->isVirtual && !i->registers[k]->isMemoryOperand && i->registers[k]->name == name;
+}
+
+bool BranchFusion::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    // first and last instruction touching each virtual register, and the closest label at or before each instruction
+    std::unordered_map<std::string, std::pair<size_t, size_t>> span;
+    std::vector<long> last_label(instructions.size());
+    long label = -1;
+    for (size_t k = 0; k < instructions.size(); k++){
+        if (std::dynamic_pointer_cast<Label>(instructions[k])){
+            label = long(k);
+        }
+        last_label[k] = label;
+
+        for (auto& r : instructions[k]->registers){
+            std::vector<std::shared_ptr<Register>> used = {r};
+            if (auto a = std::dynamic_pointer_cast<Address>(r)){
+                used = {a->base, a->index};
+            }
+            for (auto& u : used){
+                if (u && u->isVirtual){
+                    auto it = span.emplace(u->name, std::make_pair(k, k));
+                    it.first->second.second = k;
+                }
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<Instruction>> result;
+    result.reserve(instructions.size());
+    bool changed = false;
+
+    for (size_t k = 0; k < instructions.size(); k++){
+        std::shared_ptr<Instruction> set = instructions[k];
+        std::string jump = inverse_jump(set->opcode);
+
+        if (!jump.empty() && k + 3 < instructions.size() && set->registers.size() == 1 && set->registers[0]->isVirtual){
+            const std::string& t = set->registers[0]->name;
+            auto movzx = instructions[k + 1];
+            auto cmp = std::dynamic_pointer_cast<BasicInstruction>(instructions[k + 2]);
+            auto jne = std::dynamic_pointer_cast<BranchInstruction>(instructions[k + 3]);
+
+            // the temporary lives in straight line code ending at the test, so nothing reads it afterwards
+            bool fusable = movzx->opcode == "movzx" && is_register(movzx, 0, t) && is_register(movzx, 1, t)
+                           && cmp && cmp->opcode == "cmp" && cmp->registers.size() == 1 && is_register(cmp, 0, t) && cmp->value == "1"
+                           && jne && jne->registers.empty() && trimmed(jne->opcode) == "jne"
+                           && span[t].second == k + 2 && last_label[k] < long(span[t].first);
+
+            if (fusable){
+                result.push_back(std::make_shared<BranchInstruction>(jump, jne->label));
+                k += 3;
+                changed = true;
+                continue;
+            }
+        }
+        result.push_back(set);
+    }
+
+    instructions = std::move(result);
+    return changed;
+}
+
+// an inline asm line may be a label of its own
+static bool may_be_target(const std::shared_ptr<Instruction>& i) {
+    return std::dynamic_pointer_cast<Label>(i) || i->opcode == "emit_asm";
+}
+
+static bool is_jmp(const std::shared_ptr<Instruction>& i) {
+    auto branch = std::dynamic_pointer_cast<BranchInstruction>(i);
+    return branch && branch->registers.empty() && trimmed(branch->opcode) == "jmp";
+}
+
+bool JumpCleanup::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    std::vector<std::shared_ptr<Instruction>> reachable;
+    reachable.reserve(instructions.size());
+    bool dead = false;
+    for (auto& i : instructions){
+        if (may_be_target(i)){
+            dead = false;
+        }
+        if (!dead){
+            reachable.push_back(i);
+        }
+        if (is_jmp(i) || trimmed(i->opcode) == "ret"){
+            dead = true;
+        }
+    }
+    bool changed = reachable.size() != instructions.size();
+
+    std::vector<std::shared_ptr<Instruction>> result;
+    result.reserve(reachable.size());
+    for (size_t k = 0; k < reachable.size(); k++){
+        if (is_jmp(reachable[k])){
+            const std::string& target = std::static_pointer_cast<BranchInstruction>(reachable[k])->label;
+            bool falls_through = false;
+            for (size_t n = k + 1; n < reachable.size(); n++){
+                auto label = std::dynamic_pointer_cast<Label>(reachable[n]);
+                if (!label){
+                    break;
+                }
+                falls_through |= label->label == target;
+            }
+            if (falls_through){
+                changed = true;
+                continue;
+            }
+        }
+        result.push_back(reachable[k]);
+    }
+
+    instructions = std::move(result);
+    return changed;
+}
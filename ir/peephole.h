@@ -0,0 +1,33 @@
+//
+// Created by Ryan Senoune on 2025-03-14.
+//
+
+#ifndef COMPILER_PEEPHOLE_H
+#define COMPILER_PEEPHOLE_H
+
+#include "pass.h"
+
+/*
+ * A comparison used as a condition is materialized and tested again:
+ *     cmp a, b / setl %t / movzx %t, %t / cmp %t, 1 / jne L
+ * When %t is not used after the jump, the flags of the first cmp are branched on directly:
+ *     cmp a, b / jge L
+ */
+class BranchFusion : public Pass {
+public:
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+
+    // jump taken when the set condition is false, empty if the opcode is not a setcc
+    static std::string inverse_jump(const std::string& set);
+};
+
+/*
+ * Drops instructions after an unconditional jump that no label makes reachable again,
+ * then jumps to the label that directly follows them
+ */
+class JumpCleanup : public Pass {
+public:
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+};
+
+#endif //COMPILER_PEEPHOLE_H
@@ -7,62 +7,80 @@
 /*
 * Naive register allocator - maps every virtual register to a stack location
 * Loads to physical register and writes back to stack upon every usage
+* Slots are [rbp - offset], FrameLayout then reserves them and decides how they are addressed
 */
 std::unordered_map<std::string, std::string> RegAlloc::naive_reg_alloc(std::vector<std::shared_ptr<Instruction>>& instructions) {
     std::unordered_map<std::string, std::string> reg_to_mem;
-    std::vector<std::string> func_to_offset;
     std::vector<std::string> pool = {"r10", "r11"};
     int offset = 0;
 
     for (int i=0;i<instructions.size();i++) {
         auto inst = instructions[i];
         if (inst->opcode == "ret") {
-            func_to_offset.push_back(std::to_string(offset));
             offset = 0;
         }
 
-        for (auto reg : inst->registers) {
-            if (reg->isVirtual && reg_to_mem.find(reg->name) == reg_to_mem.end()) {
-                offset += 8;
-                reg_to_mem[reg->name] = "[rbp - " + std::to_string(offset) + "]";
+        for (auto operand : inst->registers) {
+            std::vector<std::shared_ptr<Register>> regs = {operand};
+            if (auto a = std::dynamic_pointer_cast<Address>(operand)) {
+                regs = {a->base, a->index};
+            }
+            for (auto reg : regs) {
+                if (reg && reg->isVirtual && reg_to_mem.find(reg->name) == reg_to_mem.end()) {
+                    offset += 8;
+                    reg_to_mem[reg->name] = "[rbp - " + std::to_string(offset) + "]";
+                    slots[reg->name] = offset;
+                }
             }
         }
 
+        // objects are padded so the slots after them stay 8 byte aligned
         if (inst->opcode == "allocate"){
-            offset += std::stoi(std::dynamic_pointer_cast<BasicInstruction>(inst)->value);
-            instructions[i] = emit("lea", inst->registers[0], "[rbp - " + std::to_string(offset) + "]");
+            offset += align(std::stoi(std::dynamic_pointer_cast<BasicInstruction>(inst)->value), 8);
+            auto object = std::make_shared<Address>(Register::get_physical_register("rbp"));
+            object->disp = -offset;
+            instructions[i] = emit("lea", inst->registers[0], object);
         }
     }
 
-    int label = 0;
     for (int i=0; i<instructions.size(); i++) {
-        if (auto p = std::dynamic_pointer_cast<Label>(instructions[i]); p && p->funcDecl) {
-            n_instructions.push_back(instructions[i]);
-            n_instructions.push_back(instructions[i+1]);
-            n_instructions.push_back(instructions[i+2]);
-            n_instructions.push_back(emit("sub", Register::get_physical_register("rsp"), func_to_offset[label++]));
-            i += 3;
-        }
-
         auto inst = instructions[i];
 
         std::vector<std::shared_ptr<Instruction>> write_back;
 
         for (int i=0;i<inst->registers.size();i++){
             auto reg = inst->registers[i];
+
+            // base goes to the operand's scratch register, index to rax which is never live across an instruction
+            if (auto a = std::dynamic_pointer_cast<Address>(reg)){
+                auto physical = std::make_shared<Address>(*a);
+                if (a->base && a->base->isVirtual){
+                    physical->base = Register::get_physical_register(pool[i%2]);
+                    n_instructions.push_back(emit("mov", physical->base, slot(a->base)));
+                }
+                if (a->index && a->index->isVirtual){
+                    physical->index = Register::get_physical_register("rax");
+                    n_instructions.push_back(emit("mov", physical->index, slot(a->index)));
+                }
+                inst->registers[i] = physical;
+                continue;
+            }
+
             if (reg->isVirtual){
                 if (inst->opcode == "lea" && i == 1){
+                    inst->registers[i] = slot(reg);
                     continue;
                 }
 
                 auto physical = Register::get_physical_register(pool[i%2], reg->size, reg->isMemoryOperand);
-                if (i == inst->registers.size()-1){
-                    n_instructions.push_back(emit("mov", Register::get_physical_register(pool[i%2]), reg->copy(8)));
+                // the destination is loaded when the instruction also reads it or addresses memory through it
+                if (i == inst->registers.size()-1 || reg->isMemoryOperand || !writes_only(inst->opcode)){
+                    n_instructions.push_back(emit("mov", Register::get_physical_register(pool[i%2]), slot(reg)));
                 }
                 inst->registers[i] = physical;
 
                 if (i == 0){
-                    write_back.push_back(emit("mov", reg->copy(8), Register::get_physical_register(pool[i%2])));
+                    write_back.push_back(emit("mov", slot(reg), Register::get_physical_register(pool[i%2])));
                 }
             }
         }
@@ -79,6 +97,22 @@ std::unordered_map<std::string, std::string> RegAlloc::naive_reg_alloc(std::vect
     return reg_to_mem;
 }
 
+// the stack slot of a virtual register, always accessed as a whole qword
+std::shared_ptr<Address> RegAlloc::slot(std::shared_ptr<Register> reg) {
+    auto address = std::make_shared<Address>(Register::get_physical_register("rbp"));
+    address->disp = -slots[reg->name];
+    return address;
+}
+
+bool RegAlloc::writes_only(const std::string& opcode) {
+    return opcode == "mov" || opcode == "movzx" || opcode == "movsx" || opcode == "movsxd" || opcode == "lea"
+           || opcode.rfind("set", 0) == 0;
+}
+
+int RegAlloc::align(int offset, int alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
 std::shared_ptr<Instruction> RegAlloc::emit(std::string opcode, std::shared_ptr<Register> r1, std::shared_ptr<Register> r2){
     std::vector<std::shared_ptr<Register>> r = {r1,r2};
     std::shared_ptr<Instruction> i = std::make_shared<BasicInstruction>(opcode, r);
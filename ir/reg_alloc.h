@@ -10,10 +10,17 @@
 class RegAlloc{
 public:
     std::vector<std::shared_ptr<Instruction>> n_instructions;
+    // frame offset of every virtual register's slot
+    std::unordered_map<std::string, int> slots;
 
     std::unordered_map<std::string, std::string> naive_reg_alloc(std::vector<std::shared_ptr<Instruction>>& instructions);
     std::shared_ptr<Instruction> emit(std::string opcode, std::shared_ptr<Register> r1, std::shared_ptr<Register> r2);
     std::shared_ptr<Instruction> emit(std::string opcode, std::shared_ptr<Register> r1, std::string value);
+    std::shared_ptr<Address> slot(std::shared_ptr<Register> reg);
+
+    // the first operand of these is only written
+    static bool writes_only(const std::string& opcode);
+    static int align(int offset, int alignment);
 
 };
 
@@ -0,0 +1,547 @@
+//
+// Created by Ryan Senoune on 2025-03-21.
+//
+
+#include "selector.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+const int infinite = INT_MAX / 4;
+
+enum Op { Mov, Lea, Alu, Neg, Shl, Imul, Cmp, Test, Setcc, Movzx };
+
+// x86-64 cost of each instruction the rules emit, roughly its latency
+const int cost_table[] = {1, 1, 1, 1, 1, 3, 1, 1, 1, 1};
+
+int cost(std::initializer_list<Op> ops) {
+    int total = 0;
+    for (Op op : ops){
+        total += cost_table[op];
+    }
+    return total;
+}
+
+bool fits(long value) {
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+// the int in the low dword of value, as the 32 bit arithmetic of an int wraps
+long wrapped(unsigned long value) {
+    long low = long(value & 0xffffffffUL);
+    return low > INT_MAX ? low - (1L << 32) : low;
+}
+
+// the two address instruction of an operator, empty when it has none
+std::string opcode(TT op) {
+    switch (op) {
+        case TT::PLUS: return "add";
+        case TT::MINUS: return "sub";
+        case TT::ASTERISK: return "imul";
+        case TT::LOGOR: return "or";
+        case TT::LOGAND: return "and";
+        default: return "";
+    }
+}
+
+bool commutes(TT op) {
+    return op == TT::PLUS || op == TT::ASTERISK || op == TT::LOGOR || op == TT::LOGAND;
+}
+
+// condition code of a comparison, with its operands swapped when asked
+std::string condition(TT op, bool swapped) {
+    switch (op) {
+        case TT::LT: return swapped ? "g" : "l";
+        case TT::LE: return swapped ? "ge" : "le";
+        case TT::GT: return swapped ? "l" : "g";
+        case TT::GE: return swapped ? "le" : "ge";
+        case TT::EQ: return "e";
+        case TT::NE: return "ne";
+        default: return "";
+    }
+}
+
+// k when value is 2^k, -1 otherwise
+int power_of_two(long value) {
+    for (int k = 1; k < 31; k++){
+        if (value == 1L << k){
+            return k;
+        }
+    }
+    return -1;
+}
+
+bool literal(const std::shared_ptr<Expr>& e, long& value) {
+    auto p = std::dynamic_pointer_cast<Primary>(e);
+    if (!p || (p->token->token_type != TT::INT_LITERAL && p->token->token_type != TT::CHAR_LITERAL)){
+        return false;
+    }
+    try {
+        value = std::stol(p->token->value);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool variable(const std::shared_ptr<Expr>& e, const std::shared_ptr<VarDecl>& decl) {
+    auto p = std::dynamic_pointer_cast<Primary>(e);
+    return p && p->token->token_type == TT::IDENTIFIER && p->symbol && p->symbol->decl == decl;
+}
+
+// whether evaluating e may read or write the variable, true for anything unknown
+bool mentions(const std::shared_ptr<Expr>& e, const std::shared_ptr<VarDecl>& decl) {
+    if (auto p = std::dynamic_pointer_cast<Primary>(e)){
+        return variable(p, decl);
+    }
+    if (auto u = std::dynamic_pointer_cast<Unary>(e)){
+        return mentions(u->expr1, decl);
+    }
+    if (auto b = std::dynamic_pointer_cast<Binary>(e)){
+        return mentions(b->expr1, decl) || mentions(b->expr2, decl);
+    }
+    if (auto c = std::dynamic_pointer_cast<TypeCast>(e)){
+        return mentions(c->expr1, decl);
+    }
+    if (auto s = std::dynamic_pointer_cast<Subscript>(e)){
+        return mentions(s->array, decl) || mentions(s->index, decl);
+    }
+    if (auto m = std::dynamic_pointer_cast<Member>(e)){
+        return mentions(m->structure, decl);
+    }
+    if (auto c = std::dynamic_pointer_cast<Call>(e)){
+        return std::any_of(c->args.begin(), c->args.end(), [&](auto& a) { return mentions(a, decl); });
+    }
+    return true;
+}
+
+}
+
+bool Selector::covers(const std::shared_ptr<Expr>& e) {
+    long value;
+    if (literal(e, value)){
+        return true;
+    }
+    if (auto u = std::dynamic_pointer_cast<Unary>(e)){
+        return u->op->token_type == TT::MINUS || u->op->token_type == TT::NOT;
+    }
+    if (auto b = std::dynamic_pointer_cast<Binary>(e)){
+        return !opcode(b->op->token_type).empty() || !condition(b->op->token_type, false).empty();
+    }
+    return false;
+}
+
+Selector::State& Selector::label(const std::shared_ptr<Expr>& e) {
+    auto it = states.find(e.get());
+    if (it != states.end()){
+        return it->second;
+    }
+
+    State s;
+    std::fill(std::begin(s.cost), std::end(s.cost), infinite);
+    std::fill(std::begin(s.rule), std::end(s.rule), Rule::None);
+    auto set = [&](Nonterminal n, int c, Rule rule) {
+        if (c < s.cost[n]){
+            s.cost[n] = c;
+            s.rule[n] = rule;
+            return true;
+        }
+        return false;
+    };
+
+    auto u = std::dynamic_pointer_cast<Unary>(e);
+    auto b = std::dynamic_pointer_cast<Binary>(e);
+    if (literal(e, s.constant)){
+        s.known = true;
+    }
+    else if (u && covers(u)){
+        State& c = label(u->expr1);
+        if (u->op->token_type == TT::MINUS){
+            s.known = c.known;
+            s.constant = wrapped(-static_cast<unsigned long>(c.constant));
+            set(Temp, c.cost[Temp] + cost({Neg}), Rule::Negate);
+        }
+        else{
+            set(Temp, c.cost[Reg] + cost({Test, Setcc, Movzx}), Rule::Not);
+        }
+    }
+    else if (b && covers(b)){
+        TT op = b->op->token_type;
+        State& l = label(b->expr1);
+        State& r = label(b->expr2);
+
+        // constants wrap around at 32 bits like the ints computing them
+        if (l.known && r.known && (op == TT::PLUS || op == TT::MINUS || op == TT::ASTERISK)){
+            auto x = static_cast<unsigned long>(l.constant);
+            auto y = static_cast<unsigned long>(r.constant);
+            s.known = true;
+            s.constant = wrapped(op == TT::PLUS ? x + y : op == TT::MINUS ? x - y : x * y);
+        }
+
+        std::string instruction = opcode(op);
+        if (!instruction.empty()){
+            for (bool swapped : {false, true}){
+                if (swapped && !commutes(op)){
+                    continue;
+                }
+                State& t = swapped ? r : l;
+                State& x = swapped ? l : r;
+                Nonterminal n = x.cost[Imm] <= x.cost[Reg] ? Imm : Reg;
+                if (set(Temp, t.cost[Temp] + x.cost[n] + cost({op == TT::ASTERISK ? Imul : Alu}), Rule::Operation)){
+                    s.operand = n;
+                    s.swapped = swapped;
+                }
+                if (op == TT::ASTERISK && x.cost[Imm] == 0 && power_of_two(x.constant) != -1
+                    && set(Temp, t.cost[Temp] + cost({Shl}), Rule::Shift)){
+                    s.swapped = swapped;
+                }
+            }
+            derive_form(b, s);
+        }
+        else{
+            // an immediate on the left is compared from the right
+            for (auto [n, m, swapped] : {std::make_tuple(Reg, Reg, false), std::make_tuple(Reg, Imm, false), std::make_tuple(Imm, Reg, true)}){
+                if (set(Temp, l.cost[n] + r.cost[m] + cost({Cmp, Setcc, Movzx}), Rule::Compare)){
+                    s.operand = swapped ? n : m;
+                    s.swapped = swapped;
+                }
+            }
+        }
+    }
+    else{
+        set(Reg, 0, Rule::Leaf);
+    }
+
+    if (s.known && fits(s.constant)){
+        set(Imm, 0, Rule::Constant);
+    }
+    closure(s);
+    return states[e.get()] = s;
+}
+
+// chain rules, temp from an imm, an addr or a reg, and reg from temp
+void Selector::closure(State& s) {
+    auto chain = [&](Nonterminal n, Nonterminal from, int c) {
+        if (c < s.cost[n]){
+            s.cost[n] = c;
+            s.rule[n] = Rule::Chain;
+            s.from[n] = from;
+        }
+    };
+    // any constant moves into a register, mov takes an imm64
+    if (s.known){
+        chain(Temp, Imm, cost({Mov}));
+    }
+    // lea needs a base, or its index twice, and a plain register is no address
+    const Form& f = s.form;
+    bool base = f.count > 0 && (f.terms[0].scale == 1 || (f.count == 2 && f.terms[1].scale == 1));
+    bool lea = (base || (f.count == 1 && f.terms[0].scale == 2)) && !(f.count == 1 && base && f.disp == 0);
+    if (s.cost[Addr] < infinite && lea){
+        chain(Temp, Addr, s.cost[Addr] + cost({Lea}));
+    }
+    chain(Temp, Reg, s.cost[Reg] + cost({Mov}));
+    chain(Reg, Temp, s.cost[Temp]);
+}
+
+// the ways an operand of an addr adds to it: a constant, its own addr or a register
+int Selector::forms(const std::shared_ptr<Expr>& e, std::pair<Form, int> (&result)[3]) {
+    State& s = label(e);
+    int n = 0;
+    if (s.cost[Imm] < infinite){
+        Form f;
+        f.disp = s.constant;
+        result[n++] = {f, s.cost[Imm]};
+    }
+    if (s.cost[Addr] < infinite){
+        result[n++] = {s.form, s.cost[Addr]};
+    }
+    if (s.cost[Reg] < infinite){
+        Form f;
+        f.terms[f.count++] = {&e, 1};
+        result[n++] = {f, s.cost[Reg]};
+    }
+    return n;
+}
+
+// base + index*scale + disp from sums and scalings, the cheapest form with at most two registers
+void Selector::derive_form(const std::shared_ptr<Binary>& b, State& s) {
+    TT op = b->op->token_type;
+    auto candidate = [&](const Form& f, int c) {
+        int scaled = 0;
+        bool valid = f.count > 0 && fits(f.disp);
+        for (int t = 0; t < f.count; t++){
+            int scale = f.terms[t].scale;
+            valid = valid && (scale == 1 || scale == 2 || scale == 4 || scale == 8);
+            scaled += scale != 1;
+        }
+        if (valid && scaled <= 1 && c < s.cost[Addr]){
+            s.cost[Addr] = c;
+            s.rule[Addr] = Rule::Form;
+            s.form = f;
+        }
+    };
+
+    std::pair<Form, int> left[3];
+    std::pair<Form, int> right[3];
+    if (op == TT::PLUS){
+        int n = forms(b->expr1, left);
+        int m = forms(b->expr2, right);
+        for (int i = 0; i < n; i++){
+            for (int j = 0; j < m; j++){
+                Form f = left[i].first;
+                const Form& r = right[j].first;
+                if (f.count + r.count > 2){
+                    continue;
+                }
+                for (int t = 0; t < r.count; t++){
+                    f.terms[f.count++] = r.terms[t];
+                }
+                f.disp += r.disp;
+                candidate(f, left[i].second + right[j].second);
+            }
+        }
+    }
+    else if (op == TT::MINUS && label(b->expr2).cost[Imm] == 0){
+        int n = forms(b->expr1, left);
+        for (int i = 0; i < n; i++){
+            left[i].first.disp -= label(b->expr2).constant;
+            candidate(left[i].first, left[i].second);
+        }
+    }
+    else if (op == TT::ASTERISK){
+        for (bool swapped : {false, true}){
+            State& factor = label(swapped ? b->expr1 : b->expr2);
+            if (factor.cost[Imm] != 0 || factor.constant <= 0){
+                continue;
+            }
+            long k = factor.constant;
+            int n = forms(swapped ? b->expr2 : b->expr1, left);
+            for (int i = 0; i < n; i++){
+                const Form& f = left[i].first;
+                Form scaled = f;
+                for (int t = 0; t < scaled.count; t++){
+                    scaled.terms[t].scale *= int(std::min(k, 16L));
+                }
+                scaled.disp *= k;
+                candidate(scaled, left[i].second);
+                // x*3 is [x + x*2]
+                if ((k == 3 || k == 5 || k == 9) && f.count == 1 && f.terms[0].scale == 1){
+                    Form twice = f;
+                    twice.terms[twice.count++] = {f.terms[0].node, int(k - 1)};
+                    twice.disp *= k;
+                    candidate(twice, left[i].second);
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<Register> Selector::value(const std::shared_ptr<Expr>& e, bool stored) {
+    label(e);
+    return stored ? reduce(e, Reg) : exact(e);
+}
+
+bool Selector::constant(const std::shared_ptr<Expr>& e, long& value) {
+    if (!covers(e)){
+        return false;
+    }
+    State& s = label(e);
+    value = s.constant;
+    return s.cost[Imm] < infinite;
+}
+
+bool Selector::assign(const std::shared_ptr<Register>& v, const std::shared_ptr<VarDecl>& decl, const std::shared_ptr<Expr>& e) {
+    if (!covers(e)){
+        return false;
+    }
+    if (auto b = std::dynamic_pointer_cast<Binary>(e)){
+        TT op = b->op->token_type;
+        std::string instruction = opcode(op);
+        bool left = !instruction.empty() && variable(b->expr1, decl) && !mentions(b->expr2, decl);
+        bool right = !instruction.empty() && commutes(op) && variable(b->expr2, decl) && !mentions(b->expr1, decl);
+        if (left || right){
+            auto& other = left ? b->expr2 : b->expr1;
+            State& x = label(other);
+            if (op == TT::ASTERISK && x.cost[Imm] == 0 && power_of_two(x.constant) != -1){
+                gen.emit("shl", v, std::to_string(power_of_two(x.constant)));
+            }
+            else{
+                gen.emit(instruction, v, operand(other, x.cost[Imm] <= x.cost[Reg] ? Imm : Reg));
+            }
+            wrap(v);
+            return true;
+        }
+    }
+    // the variable is written before the last operand is evaluated
+    if (mentions(e, decl)){
+        return false;
+    }
+    bool extend = wide(e, Temp);
+    reduce(e, Temp, v);
+    if (extend){
+        wrap(v);
+    }
+    return true;
+}
+
+std::shared_ptr<Register> Selector::index(const std::shared_ptr<Expr>& e, int size, int& disp) {
+    State& s = label(e);
+    if (s.cost[Addr] < infinite && s.form.count == 1 && s.form.terms[0].scale == 1 && fits(disp + s.form.disp * size)){
+        disp += int(s.form.disp * size);
+        return exact(*s.form.terms[0].node);
+    }
+    return exact(e);
+}
+
+std::shared_ptr<Register> Selector::reduce(const std::shared_ptr<Expr>& e, Nonterminal n, std::shared_ptr<Register> target) {
+    State& s = label(e);
+    auto u = std::dynamic_pointer_cast<Unary>(e);
+    auto b = std::dynamic_pointer_cast<Binary>(e);
+    auto fresh = [&]() { return target ? target : gen.gen_register(); };
+
+    switch (s.rule[n]) {
+        case Rule::Leaf:
+            return e->accept(gen);
+        case Rule::Chain: {
+            if (n == Reg){
+                return reduce(e, Temp, target);
+            }
+            if (s.from[n] == Imm){
+                auto t = fresh();
+                gen.emit("mov", t, std::to_string(s.constant));
+                return t;
+            }
+            if (s.from[n] == Addr){
+                auto a = address(e);
+                auto t = fresh();
+                gen.emit("lea", t, a);
+                return t;
+            }
+            auto r = reduce(e, Reg);
+            auto t = fresh();
+            gen.emit("mov", t, r);
+            return t;
+        }
+        case Rule::Operation: {
+            if (s.swapped){
+                auto x = operand(b->expr1, s.operand);
+                auto t = reduce(b->expr2, Temp, target);
+                gen.emit(opcode(b->op->token_type), t, x);
+                return t;
+            }
+            auto t = reduce(b->expr1, Temp, target);
+            gen.emit(opcode(b->op->token_type), t, operand(b->expr2, s.operand));
+            return t;
+        }
+        case Rule::Shift: {
+            auto t = reduce(s.swapped ? b->expr2 : b->expr1, Temp, target);
+            gen.emit("shl", t, std::to_string(power_of_two(label(s.swapped ? b->expr1 : b->expr2).constant)));
+            return t;
+        }
+        case Rule::Negate: {
+            auto t = reduce(u->expr1, Temp, target);
+            gen.emit("neg", t);
+            return t;
+        }
+        case Rule::Not: {
+            auto r = exact(u->expr1);
+            auto t = fresh();
+            gen.emit("test", r, r);
+            gen.emit("sete", t->copy(1));
+            gen.emit("movzx", t, t->copy(1));
+            return t;
+        }
+        case Rule::Compare: {
+            // all 64 bits are compared, so neither operand may carry
+            if (s.swapped){
+                auto r = exact(b->expr2);
+                gen.emit("cmp", r, operand(b->expr1, Imm));
+            }
+            else{
+                auto r = exact(b->expr1);
+                gen.emit("cmp", r, s.operand == Imm ? operand(b->expr2, Imm) : InstructionGen::Operand(exact(b->expr2)));
+            }
+            auto t = fresh();
+            gen.emit("set" + condition(b->op->token_type, s.swapped), t->copy(1));
+            gen.emit("movzx", t, t->copy(1));
+            return t;
+        }
+        default:
+            throw std::logic_error("No instruction selected for an expression");
+    }
+}
+
+// the addr of e as an operand, each register term evaluated once and in source order
+std::shared_ptr<Address> Selector::address(const std::shared_ptr<Expr>& e) {
+    Form f = label(e).form;
+    std::shared_ptr<Register> registers[2];
+    for (int t = 0; t < f.count; t++){
+        registers[t] = term(*f.terms[t].node);
+    }
+    std::shared_ptr<Address> a;
+    int base = f.terms[0].scale == 1 ? 0 : f.count == 2 && f.terms[1].scale == 1 ? 1 : -1;
+    if (base == -1){
+        // x*2 is [x + x]
+        a = std::make_shared<Address>(registers[0]);
+        a->index = registers[0];
+    }
+    else{
+        a = std::make_shared<Address>(registers[base]);
+        if (f.count == 2){
+            a->index = registers[1 - base];
+            a->scale = f.terms[1 - base].scale;
+        }
+    }
+    a->disp = int(f.disp);
+    return a;
+}
+
+// whether the register e reduces to may hold carries out of the int's low dword, which instructions on
+// temps leave there: the int is only exact once sign extended
+bool Selector::wide(const std::shared_ptr<Expr>& e, Nonterminal n) {
+    State& s = label(e);
+    if (n == Reg && s.rule[Reg] == Rule::Chain){
+        n = Temp;
+    }
+    switch (s.rule[n]) {
+        case Rule::Chain:
+            return s.from[n] == Addr;
+        case Rule::Operation:
+        case Rule::Shift:
+        case Rule::Negate:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Selector::wrap(const std::shared_ptr<Register>& t) {
+    gen.emit("movsxd", t, t->copy(4));
+}
+
+std::shared_ptr<Register> Selector::exact(const std::shared_ptr<Expr>& e) {
+    bool extend = wide(e, Reg);
+    auto r = reduce(e, Reg);
+    if (extend){
+        wrap(r);
+    }
+    return r;
+}
+
+std::shared_ptr<Register> Selector::term(const std::shared_ptr<Expr>& e) {
+    auto it = terms.find(e.get());
+    if (it != terms.end()){
+        return it->second;
+    }
+    return terms[e.get()] = reduce(e, Reg);
+}
+
+InstructionGen::Operand Selector::operand(const std::shared_ptr<Expr>& e, Nonterminal n) {
+    if (n == Imm){
+        return InstructionGen::Operand(std::to_string(label(e).constant));
+    }
+    return reduce(e, Reg);
+}
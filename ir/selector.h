@@ -0,0 +1,108 @@
+//
+// Created by Ryan Senoune on 2025-03-21.
+//
+
+#ifndef COMPILER_SELECTOR_H
+#define COMPILER_SELECTOR_H
+
+#include <unordered_map>
+#include "instruction_gen.h"
+
+/*
+ * Tree pattern instruction selection for integer expressions
+ *
+ * The tree of + - * comparisons || && unary - and ! is labeled bottom up: every node gets, for each
+ * nonterminal, the cheapest rule deriving it and what it costs with the x86-64 cost table. Reducing the
+ * root then emits the chosen rules top down. Nonterminals are
+ *   imm   a constant fitting an imm32, literals and constant arithmetic folded
+ *   reg   a register holding the value, a variable's own register which must not be written
+ *   temp  a register of the expression's own, which instructions may update in place
+ *   addr  base + index*scale + disp computed by a single lea, like a + b*4 + 8 or a*5
+ * Anything else (variables, loads, calls, divisions...) is a leaf InstructionGen evaluates into a reg,
+ * in source order.
+ *
+ * Ints wrap at 32 bits. Registers are 64 bit, so add, sub, imul, shl, neg and lea may leave carries above
+ * the low dword; a value is sign extended from its low dword before anything reads all of it (compares,
+ * indices, calls, other statements). A dword store only reads the low dword and skips it.
+ */
+class Selector {
+public:
+    explicit Selector(InstructionGen& gen) : gen(gen) {}
+
+    // whether the node is an operator the selector matches, anything else is a leaf
+    static bool covers(const std::shared_ptr<Expr>& e);
+
+    // register holding the value of e, only its low dword when the value is just stored
+    std::shared_ptr<Register> value(const std::shared_ptr<Expr>& e, bool stored = false);
+    // whether e folds to a constant fitting an imm32, as in -1 or 2 * 4
+    bool constant(const std::shared_ptr<Expr>& e, long& value);
+    // v = e computed in v itself, by v op= x when e is v op x. False when e reads v otherwise or is a leaf
+    bool assign(const std::shared_ptr<Register>& v, const std::shared_ptr<VarDecl>& decl, const std::shared_ptr<Expr>& e);
+    // register holding an array index, a constant it adds to a single term, as in a[i + 1], goes to disp
+    std::shared_ptr<Register> index(const std::shared_ptr<Expr>& e, int size, int& disp);
+
+private:
+    enum Nonterminal { Imm, Reg, Temp, Addr, Nonterminals };
+
+    enum class Rule {
+        None,
+        Constant,   // imm, a literal or folded arithmetic
+        Leaf,       // reg, evaluated by InstructionGen
+        Chain,      // reg <- temp, temp <- imm | reg | addr
+        Operation,  // temp <- op(temp, reg | imm), either way round when op commutes
+        Shift,      // temp <- temp * 2^k
+        Negate,     // temp <- -temp
+        Not,        // temp <- !reg
+        Compare,    // temp <- cmp(reg, reg | imm), either way round
+        Form        // addr <- sums and scalings of reg and imm
+    };
+
+    // up to two register terms in source order, a node twice for a*3 = [a + a*2]. Terms point into the
+    // tree, which outlives the selector
+    struct Term {
+        const std::shared_ptr<Expr>* node = nullptr;
+        int scale = 0;
+    };
+    struct Form {
+        Term terms[2] = {};
+        int count = 0;
+        long disp = 0;
+    };
+
+    struct State {
+        int cost[Nonterminals];
+        Rule rule[Nonterminals];
+        // Chain source for temp and reg
+        Nonterminal from[Nonterminals];
+        // constant value, when known, which imm needs to fit in 32 bits
+        bool known = false;
+        long constant = 0;
+        Form form;
+        // temp <- op: the operand's nonterminal and whether the temp is the right child
+        Nonterminal operand = Reg;
+        bool swapped = false;
+    };
+
+    InstructionGen& gen;
+    std::unordered_map<Expr*, State> states;
+    // registers of the terms of the addr being reduced
+    std::unordered_map<Expr*, std::shared_ptr<Register>> terms;
+
+    State& label(const std::shared_ptr<Expr>& e);
+    void closure(State& s);
+    int forms(const std::shared_ptr<Expr>& e, std::pair<Form, int> (&result)[3]);
+    void derive_form(const std::shared_ptr<Binary>& b, State& s);
+
+    std::shared_ptr<Register> reduce(const std::shared_ptr<Expr>& e, Nonterminal n, std::shared_ptr<Register> target = nullptr);
+    std::shared_ptr<Address> address(const std::shared_ptr<Expr>& e);
+    std::shared_ptr<Register> term(const std::shared_ptr<Expr>& e);
+    bool wide(const std::shared_ptr<Expr>& e, Nonterminal n);
+    // movsxd t, t32
+    void wrap(const std::shared_ptr<Register>& t);
+    // reg holding e sign extended from its low dword
+    std::shared_ptr<Register> exact(const std::shared_ptr<Expr>& e);
+    // an operand reduced to a register, or the immediate
+    InstructionGen::Operand operand(const std::shared_ptr<Expr>& e, Nonterminal n);
+};
+
+#endif //COMPILER_SELECTOR_H
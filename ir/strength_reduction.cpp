@@ -0,0 +1,589 @@
+//
+// Created by Ryan Senoune on 2025-03-18.
+//
+
+#include "strength_reduction.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <set>
+#include <unordered_set>
+
+namespace {
+
+// coef * i + base + offset, base an invariant register or -1
+struct Linear {
+    long coef = 0;
+    int base = -1;
+    long offset = 0;
+
+    // this += other * times, false when two registers would have to be added
+    bool add(const Linear& other, long times = 1) {
+        if (other.base != -1 && (base != -1 || times != 1)){
+            return false;
+        }
+        coef += other.coef * times;
+        offset += other.offset * times;
+        if (other.base != -1){
+            base = other.base;
+        }
+        return true;
+    }
+
+    bool scale(long times) {
+        if (base != -1 && times != 1){
+            return false;
+        }
+        coef *= times;
+        offset *= times;
+        return true;
+    }
+};
+
+// an address of the loop rewritten to [pointer + index*scale + disp]
+struct Rewrite {
+    size_t at;
+    size_t operand;
+    int pointer;
+    long disp;
+    int index;
+    int scale;
+};
+
+bool fits(long value) {
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+class Reducer {
+public:
+    Reducer(std::vector<std::shared_ptr<Instruction>>& instructions, Operands& operands, const Constants& constants, const CFG& cfg,
+            const Loop& loop) : instructions(instructions), operands(operands), constants(constants), cfg(cfg), loop(loop) {}
+
+    bool reduce();
+
+private:
+    std::vector<std::shared_ptr<Instruction>>& instructions;
+    Operands& operands;
+    const Constants& constants;
+    const CFG& cfg;
+    const Loop& loop;
+
+    std::vector<bool> inside;
+    // assignments in the loop, first and last of them, and their block, -2 for several
+    std::vector<int> assignments;
+    std::vector<long> first;
+    std::vector<long> last;
+    std::vector<int> block;
+    // instructions of the loop mentioning each register, and whether any outside does
+    std::vector<int> mentions;
+    std::vector<bool> outside;
+
+    // the induction variable being reduced, its step, the instruction of i = i + step and the last one
+    // updating i, the movsxd wrapping it when there is one
+    int iv = -1;
+    long step = 0;
+    size_t increment = 0;
+    size_t updated = 0;
+
+    // registers linear in the induction variable, computed and used in one block
+    std::vector<bool> derived;
+    std::vector<Linear> form;
+    std::vector<long> start;
+
+    bool induction(int r);
+    bool wraps(size_t k, int r) const;
+    bool attempt();
+    bool evaluate(int r);
+    bool apply(size_t k, Linear& value, long& from);
+    bool operand_form(const std::shared_ptr<Register>& reg, size_t k, Linear& value, long& from);
+    std::vector<bool> alive(const std::set<std::pair<size_t, size_t>>& rewritten, const std::vector<bool>& skipped) const;
+    std::shared_ptr<Register> reg(int r) const;
+};
+
+std::shared_ptr<Register> Reducer::reg(int r) const {
+    return std::make_shared<VirtualRegister>(std::stoi(operands.names[r]));
+}
+
+bool Reducer::reduce() {
+    int preheader = LoopInfo::preheader(cfg, loop);
+    if (preheader == -1){
+        return false;
+    }
+
+    inside.assign(instructions.size(), false);
+    for (int b : loop.blocks){
+        for (size_t k = cfg.blocks[b]->begin; k < cfg.blocks[b]->end; k++){
+            inside[k] = true;
+        }
+    }
+
+    int count = operands.count;
+    assignments.assign(count, 0);
+    first.assign(count, -1);
+    last.assign(count, -1);
+    block.assign(count, -1);
+    mentions.assign(count, 0);
+    outside.assign(count, false);
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        std::vector<int> once = operands.mentioned[k];
+        std::sort(once.begin(), once.end());
+        once.erase(std::unique(once.begin(), once.end()), once.end());
+        for (int m : once){
+            if (inside[k]){
+                mentions[m]++;
+            }
+            else{
+                outside[m] = true;
+            }
+        }
+        if (inside[k] && r != -1){
+            assignments[r]++;
+            if (first[r] == -1){
+                first[r] = long(k);
+                block[r] = cfg.block_of[k];
+            }
+            else if (block[r] != cfg.block_of[k]){
+                block[r] = -2;
+            }
+            last[r] = long(k);
+        }
+    }
+    for (int r = 0; r < count; r++){
+        if (induction(r) && attempt()){
+            return true;
+        }
+    }
+    return false;
+}
+
+// movsxd r, r32
+bool Reducer::wraps(size_t k, int r) const {
+    auto& i = instructions[k];
+    return CFG::trimmed(i->opcode) == "movsxd" && i->registers.size() == 2 && Operands::virtual_register(i->registers[1]) && i->registers[1]->size == 4
+           && operands.assigned[k] == r && operands.mentioned[k] == std::vector<int>{r, r};
+}
+
+// i is assigned in the loop by add i, step, alone or followed by the movsxd wrapping it
+bool Reducer::induction(int r) {
+    if (assignments[r] != 1 && (assignments[r] != 2 || last[r] != first[r] + 1 || !wraps(last[r], r))){
+        return false;
+    }
+    size_t k = first[r];
+    auto add = std::dynamic_pointer_cast<BasicInstruction>(instructions[k]);
+    std::string opcode = CFG::trimmed(instructions[k]->opcode);
+    if (!add || (opcode != "add" && opcode != "sub") || operands.mentioned[k][0] != r){
+        return false;
+    }
+    long s;
+    if (add->registers.size() == 1 && Constants::immediate(add->value, s)){
+    }
+    else if (add->registers.size() == 2 && operands.mentioned[k].size() == 2 && constants.known(operands.mentioned[k][1])){
+        s = constants.value(operands.mentioned[k][1]);
+    }
+    else{
+        return false;
+    }
+    if (s == 0 || last[r] + 1 >= long(instructions.size()) || Operands::reads_flags(instructions[last[r] + 1])){
+        return false;
+    }
+
+    iv = r;
+    step = opcode == "add" ? s : -s;
+    increment = k;
+    updated = last[r];
+    return true;
+}
+
+bool Reducer::operand_form(const std::shared_ptr<Register>& r, size_t k, Linear& value, long& from) {
+    if (!Operands::virtual_register(r)){
+        return false;
+    }
+    int id = operands.id(r->name);
+    int target = operands.assigned[k];
+    if (id == iv){
+        value = {1, -1, 0};
+        from = std::min(from, long(k));
+    }
+    else if (constants.known(id)){
+        value = {0, -1, constants.value(id)};
+    }
+    else if (first[id] == -1){
+        value = {0, id, 0};
+    }
+    else if (derived[id] && block[id] == block[target] && last[id] < first[target]){
+        value = form[id];
+        from = std::min(from, start[id]);
+    }
+    else{
+        return false;
+    }
+    return true;
+}
+
+// the value of the assigned register after instruction k, from its value before
+bool Reducer::apply(size_t k, Linear& value, long& from) {
+    auto i = std::dynamic_pointer_cast<BasicInstruction>(instructions[k]);
+    if (!i){
+        return false;
+    }
+    std::string opcode = CFG::trimmed(i->opcode);
+    // an int wrapping at 32 bits keeps its value: C leaves signed overflow undefined, so i and what the loop
+    // computes from it are taken not to overflow
+    if (wraps(k, operands.assigned[k])){
+        return true;
+    }
+    long immediate = 0;
+    bool has_immediate = i->registers.size() == 1 && Constants::immediate(i->value, immediate);
+    Linear source;
+    if (i->registers.size() == 2 && opcode != "lea" && !operand_form(i->registers[1], k, source, from)){
+        return false;
+    }
+    if (has_immediate){
+        source = {0, -1, immediate};
+    }
+
+    if (opcode == "mov" || opcode == "movsxd"){
+        if (i->registers.size() == 1 && !has_immediate){
+            return false;
+        }
+        value = source;
+        return true;
+    }
+    if (opcode == "lea"){
+        auto a = std::dynamic_pointer_cast<Address>(i->registers[1]);
+        Linear term;
+        value = {0, -1, a->disp};
+        if (a->base && (!operand_form(a->base, k, term, from) || !value.add(term))){
+            return false;
+        }
+        return !a->index || (operand_form(a->index, k, term, from) && value.add(term, a->scale));
+    }
+    if (opcode == "neg"){
+        return value.scale(-1);
+    }
+    if (i->registers.size() == 1 && !has_immediate){
+        return false;
+    }
+    if (opcode == "add"){
+        return value.add(source);
+    }
+    if (opcode == "sub"){
+        return value.add(source, -1);
+    }
+    if (opcode == "shl"){
+        return has_immediate && immediate >= 0 && immediate < 32 && value.scale(1L << immediate);
+    }
+    if (opcode == "imul"){
+        return source.coef == 0 && source.base == -1 && value.scale(source.offset);
+    }
+    return false;
+}
+
+// a register only the loop uses, computed from i in straight line code and used after in the same block
+bool Reducer::evaluate(int r) {
+    if (r == iv || outside[r] || block[r] < 0 || !operands.overwrites[first[r]]){
+        return false;
+    }
+    Linear value;
+    long from = first[r];
+    int seen = 0;
+    for (size_t k = first[r]; long(k) <= last[r]; k++){
+        if (!operands.mentions(k, r)){
+            continue;
+        }
+        seen++;
+        // the instruction may go away, so nothing may read the flags it sets
+        if (operands.assigned[k] != r || !apply(k, value, from) || (k + 1 < instructions.size() && Operands::reads_flags(instructions[k + 1]))){
+            return false;
+        }
+    }
+    long used = last[r];
+    for (size_t k = last[r] + 1; k < cfg.blocks[block[r]]->end; k++){
+        if (operands.mentions(k, r)){
+            seen++;
+            used = long(k);
+        }
+    }
+    // i must not move between reading it and the last use
+    if (seen != mentions[r] || (cfg.block_of[increment] == block[r] && from < long(increment) && long(increment) < used)){
+        return false;
+    }
+    derived[r] = true;
+    form[r] = value;
+    start[r] = from;
+    return true;
+}
+
+// registers whose values are still needed, given the addresses rewritten and the instructions removed
+std::vector<bool> Reducer::alive(const std::set<std::pair<size_t, size_t>>& rewritten, const std::vector<bool>& skipped) const {
+    std::vector<bool> result(operands.count, false);
+    std::vector<std::pair<int, int>> edges;
+    for (size_t k = 0; k < instructions.size(); k++){
+        if (!inside[k] || skipped[k]){
+            continue;
+        }
+        int target = operands.assigned[k];
+        bool chain = target != -1 && derived[target];
+        auto& registers = instructions[k]->registers;
+        // mentioned lists each operand's registers in order, base before index
+        size_t m = 0;
+        for (size_t j = 0; j < registers.size(); j++){
+            std::vector<std::shared_ptr<Register>> used = {registers[j]};
+            if (auto a = std::dynamic_pointer_cast<Address>(registers[j])){
+                used = {a->base, a->index};
+            }
+            for (auto& u : used){
+                if (!u || !u->isVirtual){
+                    continue;
+                }
+                int r = operands.mentioned[k][m++];
+                if (rewritten.count({k, j})){
+                    continue;
+                }
+                if (chain){
+                    edges.push_back({r, target});
+                }
+                else{
+                    result[r] = true;
+                }
+            }
+        }
+    }
+    bool grew = true;
+    while (grew){
+        grew = false;
+        for (auto& [r, target] : edges){
+            if (result[target] && !result[r]){
+                result[r] = grew = true;
+            }
+        }
+    }
+    return result;
+}
+
+bool Reducer::attempt() {
+    int count = operands.count;
+    derived.assign(count, false);
+    form.assign(count, Linear());
+    start.assign(count, 0);
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        if (inside[k] && r != -1 && first[r] == long(k)){
+            evaluate(r);
+        }
+    }
+
+    // memory operands linear in i, grouped by the pointer replacing them
+    std::map<std::pair<long, int>, int> groups;
+    std::vector<Rewrite> rewrites;
+    std::set<std::pair<size_t, size_t>> rewritten;
+    for (size_t k = 0; k < instructions.size(); k++){
+        int target = operands.assigned[k];
+        if (!inside[k] || (instructions[k]->opcode == "lea" && target != -1 && derived[target])){
+            continue;
+        }
+        for (size_t j = 0; j < instructions[k]->registers.size(); j++){
+            auto a = std::dynamic_pointer_cast<Address>(instructions[k]->registers[j]);
+            if (!a){
+                continue;
+            }
+            Linear value;
+            int index = -1;
+            int scale = 1;
+            bool linear = true;
+            for (auto [r, times] : {std::make_pair(a->base, 1), std::make_pair(a->index, a->scale)}){
+                if (!r){
+                    continue;
+                }
+                int id = Operands::virtual_register(r) ? operands.id(r->name) : -1;
+                if (id == iv || (id != -1 && derived[id])){
+                    linear = linear && value.add(id == iv ? Linear{1, -1, 0} : form[id], times);
+                }
+                else if (id != -1 && first[id] == -1 && times == 1 && value.base == -1){
+                    value.base = id;
+                }
+                else if (id != -1 && first[id] == -1 && index == -1){
+                    index = id;
+                    scale = times;
+                }
+                else{
+                    linear = false;
+                }
+            }
+            long disp = value.offset + a->disp;
+            if (!linear || value.coef == 0 || !fits(disp) || !fits(value.coef * step)){
+                continue;
+            }
+            auto key = std::make_pair(value.coef, value.base);
+            int pointer = groups.emplace(key, int(groups.size())).first->second;
+            rewrites.push_back({k, j, pointer, disp, index, scale});
+            rewritten.insert({k, j});
+        }
+    }
+    if (groups.empty()){
+        return false;
+    }
+
+    // the exit test cmp x, n with x a copy of i and n invariant, followed by its jump
+    long exit = -1;
+    for (size_t k = 0; k < instructions.size() && exit == -1; k++){
+        auto& i = instructions[k];
+        if (!inside[k] || i->opcode != "cmp" || k + 1 >= instructions.size() || !Operands::reads_flags(instructions[k + 1])
+            || !Operands::virtual_register(i->registers[0]) || i->registers[0]->size != 8){
+            continue;
+        }
+        int x = operands.mentioned[k][0];
+        bool copy_of_i = x == iv || (derived[x] && form[x].coef == 1 && form[x].base == -1 && form[x].offset == 0);
+        long immediate;
+        bool invariant = i->registers.size() == 1 ? Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(i)->value, immediate)
+                : Operands::virtual_register(i->registers[1]) && i->registers[1]->size == 8 && first[operands.mentioned[k][1]] == -1;
+        if (copy_of_i && invariant){
+            exit = long(k);
+        }
+    }
+
+    // with the increment and the exit test gone, nothing may need i any more
+    std::vector<bool> skipped(instructions.size(), false);
+    bool removes_iv = false;
+    int exit_group = -1;
+    for (auto& [key, g] : groups){
+        if (key.first > 0 && exit_group == -1){
+            exit_group = g;
+        }
+    }
+    if (exit != -1 && exit_group != -1){
+        skipped[increment] = skipped[updated] = skipped[exit] = true;
+        removes_iv = !alive(rewritten, skipped)[iv];
+        if (removes_iv){
+            Liveness liveness(cfg, operands);
+            for (int b : loop.blocks){
+                for (int s : cfg.blocks[b]->successors){
+                    removes_iv = removes_iv && (loop.contains(s) || !liveness.live_in(s, iv));
+                }
+            }
+        }
+        if (!removes_iv){
+            skipped.assign(instructions.size(), false);
+        }
+    }
+    std::vector<bool> needed = alive(rewritten, skipped);
+
+    std::vector<bool> removed(instructions.size(), false);
+    int saved = 0;
+    for (size_t k = 0; k < instructions.size(); k++){
+        int r = operands.assigned[k];
+        if (inside[k] && ((r != -1 && derived[r] && !needed[r]) || (skipped[k] && long(k) != exit))){
+            removed[k] = true;
+            saved++;
+        }
+    }
+    if (saved <= int(groups.size())){
+        return false;
+    }
+
+    // pointers start at coef * i + base, limit is the exit test's bound scaled the same way
+    std::vector<std::shared_ptr<Register>> pointers(groups.size());
+    std::vector<std::shared_ptr<Instruction>> setup;
+    std::vector<std::shared_ptr<Instruction>> advance;
+    auto scaled = [&](std::shared_ptr<Register> to, std::shared_ptr<Instruction> from, long coef, int base) {
+        setup.push_back(from);
+        if (coef != 1){
+            setup.push_back(std::make_shared<BasicInstruction>("imul", std::vector<std::shared_ptr<Register>>{to}, std::to_string(coef)));
+        }
+        if (base != -1){
+            setup.push_back(std::make_shared<BasicInstruction>("add", std::vector<std::shared_ptr<Register>>{to, reg(base)}));
+        }
+    };
+    for (auto& [key, g] : groups){
+        pointers[g] = operands.fresh();
+        scaled(pointers[g], std::make_shared<BasicInstruction>("mov", std::vector<std::shared_ptr<Register>>{pointers[g], reg(iv)}),
+               key.first, key.second);
+        advance.push_back(std::make_shared<BasicInstruction>("add", std::vector<std::shared_ptr<Register>>{pointers[g]},
+                                                             std::to_string(key.first * step)));
+    }
+    std::shared_ptr<Instruction> test;
+    if (removes_iv){
+        auto& cmp = instructions[exit];
+        auto limit = operands.fresh();
+        long immediate;
+        bool constant = cmp->registers.size() == 1 && Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(cmp)->value, immediate);
+        for (auto& [key, g] : groups){
+            if (g != exit_group){
+                continue;
+            }
+            // an immediate bound is scaled right away
+            if (constant && fits(immediate * key.first)){
+                scaled(limit, std::make_shared<BasicInstruction>("mov", std::vector<std::shared_ptr<Register>>{limit},
+                                                                 std::to_string(immediate * key.first)), 1, key.second);
+            }
+            else if (constant){
+                scaled(limit, std::make_shared<BasicInstruction>("mov", std::vector<std::shared_ptr<Register>>{limit},
+                                                                 std::to_string(immediate)), key.first, key.second);
+            }
+            else{
+                scaled(limit, std::make_shared<BasicInstruction>("mov", std::vector<std::shared_ptr<Register>>{limit, cmp->registers[1]}),
+                       key.first, key.second);
+            }
+        }
+        test = std::make_shared<BasicInstruction>("cmp", std::vector<std::shared_ptr<Register>>{pointers[exit_group], limit});
+    }
+
+    for (auto& w : rewrites){
+        auto& operand = instructions[w.at]->registers[w.operand];
+        auto a = std::make_shared<Address>(*std::dynamic_pointer_cast<Address>(operand));
+        a->base = pointers[w.pointer];
+        a->index = w.index == -1 ? nullptr : reg(w.index);
+        a->scale = w.index == -1 ? 1 : w.scale;
+        a->disp = int(w.disp);
+        operand = a;
+    }
+
+    std::vector<std::shared_ptr<Instruction>> result;
+    result.reserve(instructions.size() + setup.size() + advance.size());
+    size_t header = cfg.blocks[loop.header]->begin;
+    for (size_t k = 0; k < instructions.size(); k++){
+        if (k == header){
+            result.insert(result.end(), setup.begin(), setup.end());
+        }
+        if (long(k) == exit && test){
+            result.push_back(test);
+        }
+        else if (!removed[k]){
+            result.push_back(instructions[k]);
+        }
+        if (k == updated){
+            result.insert(result.end(), advance.begin(), advance.end());
+        }
+    }
+    instructions = std::move(result);
+    return true;
+}
+
+}
+
+bool StrengthReduction::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    // every reduction rebuilds the analyses, loops with nothing left to reduce are not tried again
+    bool changed = false;
+    std::unordered_set<std::string> done;
+    bool reduced = true;
+    while (reduced){
+        reduced = false;
+        CFG cfg = CFG::build(instructions);
+        Operands operands(instructions);
+        Constants constants(instructions, operands);
+        LoopInfo info(cfg);
+        for (int l : info.innermost_first()){
+            auto label = std::dynamic_pointer_cast<Label>(cfg.blocks[info.loops[l].header]->instructions.front());
+            if (!label || done.count(label->label)){
+                continue;
+            }
+            if (Reducer(instructions, operands, constants, cfg, info.loops[l]).reduce()){
+                reduced = changed = true;
+                break;
+            }
+            done.insert(label->label);
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,28 @@
+//
+// Created by Ryan Senoune on 2025-03-18.
+//
+
+#ifndef COMPILER_STRENGTH_REDUCTION_H
+#define COMPILER_STRENGTH_REDUCTION_H
+
+#include "pass.h"
+#include "dataflow.h"
+#include "loop_info.h"
+
+/*
+ * Induction variable strength reduction
+ *
+ * A basic induction variable i is assigned in its loop only by i = i + step, step a constant. Registers
+ * computed from it in straight line code (mov, lea, add, shl, imul by constants) are linear in i, and
+ * so is every address built from them, like [a + %t*4 + 8] after lea %t [i + i*4]. Each such address
+ * becomes [p + 8] with a pointer p = 20*i + a set up in the preheader and advanced next to i, and the
+ * computations only these addresses used are deleted. When nothing else reads i, and it is dead after
+ * the loop, the exit test compares p against the limit scaled the same way and i is removed as well.
+ * Nothing changes unless more instructions go away per iteration than pointer increments are added.
+ */
+class StrengthReduction : public Pass {
+public:
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+};
+
+#endif //COMPILER_STRENGTH_REDUCTION_H
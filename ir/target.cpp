@@ -0,0 +1,24 @@
+//
+// Created by Ryan Senoune on 2025-03-19.
+//
+
+#include "target.h"
+#include <stdexcept>
+
+Target Target::parse(const std::string& march) {
+    Target target;
+    target.march = march;
+    if (march == "x86-64"){
+        target.vector = Vector::SSE2;
+    }
+    else if (march == "x86-64-v2"){
+        target.vector = Vector::SSE41;
+    }
+    else if (march == "x86-64-v3"){
+        target.vector = Vector::AVX2;
+    }
+    else{
+        throw std::invalid_argument("Unknown -march '" + march + "', levels are x86-64, x86-64-v2 and x86-64-v3");
+    }
+    return target;
+}
@@ -0,0 +1,33 @@
+//
+// Created by Ryan Senoune on 2025-03-19.
+//
+
+#ifndef COMPILER_TARGET_H
+#define COMPILER_TARGET_H
+
+#include <string>
+
+/*
+ * The x86-64 level code is generated for, picked with -march=
+ * x86-64 only has SSE2, x86-64-v2 adds SSE4.1 (pmulld), x86-64-v3 adds AVX2
+ */
+struct Target {
+    enum class Vector {
+        SSE2,
+        SSE41,
+        AVX2
+    };
+
+    std::string march = "x86-64";
+    Vector vector = Vector::SSE2;
+
+    // throws std::invalid_argument on an unknown level
+    static Target parse(const std::string& march);
+
+    // bytes in a vector register
+    int vector_width() const {
+        return vector == Vector::AVX2 ? 32 : 16;
+    }
+};
+
+#endif //COMPILER_TARGET_H
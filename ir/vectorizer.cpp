@@ -0,0 +1,708 @@
+//
+// Created by Ryan Senoune on 2025-03-19.
+//
+
+#include "vectorizer.h"
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+
+namespace {
+
+// xmm15 belongs to struct copies
+const int vector_registers = 15;
+
+// a dword access [base + i*4 + disp] of the loop body
+struct Access {
+    int base;
+    long disp;
+    bool store;
+};
+
+// what a register holds in the body: the same value in every lane, an int per lane, or a partial sum per
+// lane which must end up in its reduction register, summed into another register or stored nowhere else
+enum class Kind {
+    Unseen,
+    Invariant,
+    Vector,
+    Sum,
+    Summed
+};
+
+class Vectorizer {
+public:
+    Vectorizer(std::vector<std::shared_ptr<Instruction>>& instructions, Operands& operands, const Constants& constants, const CFG& cfg,
+               const Loop& loop, const Target& target)
+            : instructions(instructions), operands(operands), constants(constants), cfg(cfg), loop(loop), target(target),
+              avx(target.vector == Target::Vector::AVX2), lanes(target.vector_width() / 4) {}
+
+    // false leaves the instructions as they were
+    bool vectorize();
+
+    // label of the vector loop, for a header label
+    static std::string vector_label(const std::string& header) {
+        return header + "_vec";
+    }
+
+private:
+    std::vector<std::shared_ptr<Instruction>>& instructions;
+    Operands& operands;
+    const Constants& constants;
+    const CFG& cfg;
+    const Loop& loop;
+    const Target& target;
+    bool avx;
+    int lanes;
+
+    std::string label;
+    std::string exit_opcode;
+    int iv = -1;
+    // bound of i < bound, an immediate when -1
+    int bound = -1;
+    long bound_value = 0;
+    // the body without the increment of i and the jump back
+    size_t begin = 0;
+    size_t end = 0;
+
+    std::vector<Kind> kind;
+    // reduction register each partial sum belongs to
+    std::vector<int> owner;
+    std::vector<int> reductions;
+    std::vector<Access> accesses;
+    // registers assigned once in the function by allocate, distinct objects
+    std::vector<bool> object;
+    // invariant registers and immediates used as vectors, broadcast in front of the loop
+    std::set<int> broadcasts;
+    std::set<long> immediates;
+    // last instruction of the body mentioning a register
+    std::vector<size_t> last;
+
+    std::vector<int> xmm;
+    std::map<long, int> immediate_xmm;
+    std::vector<bool> busy;
+
+    std::vector<std::shared_ptr<Instruction>> code;
+
+    bool structure();
+    bool classify();
+    bool address(const std::shared_ptr<Register>& r, bool store);
+    bool combination(const std::shared_ptr<Register>& r);
+    bool source(size_t k, Kind& source_kind, int& source_id);
+    bool define(int r);
+
+    int take();
+    std::shared_ptr<Register> vector(int n, int width = 0) const;
+    std::shared_ptr<Register> reg(int r, int size = 8) const;
+    int operand(size_t k);
+    void emit(const std::string& opcode, std::vector<std::shared_ptr<Register>> registers, const std::string& value = "");
+    void op(const std::string& opcode, int d, int s);
+    void copy(int d, int s);
+    void broadcast(int n, const std::shared_ptr<Register>& from);
+    bool translate(size_t k);
+};
+
+std::shared_ptr<Register> Vectorizer::vector(int n, int width) const {
+    return Register::vector_register(n, width ? width : target.vector_width());
+}
+
+std::shared_ptr<Register> Vectorizer::reg(int r, int size) const {
+    auto result = std::make_shared<VirtualRegister>(std::stoi(operands.names[r]));
+    result->size = size;
+    return result;
+}
+
+void Vectorizer::emit(const std::string& opcode, std::vector<std::shared_ptr<Register>> registers, const std::string& value) {
+    code.push_back(std::make_shared<BasicInstruction>(opcode, std::move(registers), value));
+}
+
+// two operand SSE, the three operand AVX form with the destination as first source
+void Vectorizer::op(const std::string& opcode, int d, int s) {
+    if (avx){
+        emit("v" + opcode, {vector(d), vector(d), vector(s)});
+    }
+    else{
+        emit(opcode, {vector(d), vector(s)});
+    }
+}
+
+void Vectorizer::copy(int d, int s) {
+    if (d != s){
+        emit(avx ? "vmovdqa" : "movdqa", {vector(d), vector(s)});
+    }
+}
+
+void Vectorizer::broadcast(int n, const std::shared_ptr<Register>& from) {
+    if (avx){
+        emit("vmovd", {vector(n, 16), from});
+        emit("vpbroadcastd", {vector(n), vector(n, 16)});
+    }
+    else{
+        emit("movd", {vector(n), from});
+        emit("pshufd", {vector(n), vector(n)}, "0");
+    }
+}
+
+int Vectorizer::take() {
+    for (int n = 0; n < vector_registers; n++){
+        if (!busy[n]){
+            busy[n] = true;
+            return n;
+        }
+    }
+    return -1;
+}
+
+// the loop is a test block i < n and a body ending with i = i + 1 and the jump back
+bool Vectorizer::structure() {
+    if (loop.blocks.size() != 2 || loop.blocks[1] != loop.header + 1 || LoopInfo::preheader(cfg, loop) == -1){
+        return false;
+    }
+    auto& head = *cfg.blocks[loop.header];
+    auto& body = *cfg.blocks[loop.header + 1];
+    if (head.end - head.begin != 3 || body.end - body.begin < 3){
+        return false;
+    }
+    size_t h = head.begin;
+    auto header = std::dynamic_pointer_cast<Label>(instructions[h]);
+    auto exit = std::dynamic_pointer_cast<BranchInstruction>(instructions[h + 2]);
+    auto back = std::dynamic_pointer_cast<BranchInstruction>(instructions[body.end - 1]);
+    if (!header || !exit || !back || CFG::trimmed(back->opcode) != "jmp" || back->label != header->label){
+        return false;
+    }
+    label = header->label;
+    exit_opcode = CFG::trimmed(exit->opcode);
+    if (exit_opcode != "jge" && exit_opcode != "jg"){
+        return false;
+    }
+
+    // cmp i, n
+    auto& test = instructions[h + 1];
+    if (test->opcode != "cmp" || !Operands::virtual_register(test->registers[0]) || test->registers[0]->size != 8){
+        return false;
+    }
+    iv = operands.mentioned[h + 1][0];
+    if (test->registers.size() == 1){
+        if (!Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(test)->value, bound_value)){
+            return false;
+        }
+    }
+    else if (Operands::virtual_register(test->registers[1]) && test->registers[1]->size == 8){
+        bound = operands.mentioned[h + 1][1];
+    }
+    else{
+        return false;
+    }
+
+    // add i, 1, then the movsxd wrapping i when there is one
+    size_t k = body.end - 2;
+    auto& wrap = instructions[k];
+    if (CFG::trimmed(wrap->opcode) == "movsxd" && k > body.begin && !std::dynamic_pointer_cast<Address>(wrap->registers[1])
+        && operands.assigned[k] == iv && operands.mentioned[k] == std::vector<int>{iv, iv}){
+        k--;
+    }
+    auto step = std::dynamic_pointer_cast<BasicInstruction>(instructions[k]);
+    if (!step || CFG::trimmed(step->opcode) != "add" || operands.assigned[k] != iv || operands.mentioned[k][0] != iv){
+        return false;
+    }
+    long one;
+    bool by_one = step->registers.size() == 1 ? Constants::immediate(step->value, one) && one == 1
+            : operands.mentioned[k].size() == 2 && constants.known(operands.mentioned[k][1]) && constants.value(operands.mentioned[k][1]) == 1;
+    if (!by_one){
+        return false;
+    }
+
+    begin = body.begin;
+    end = k;
+    return true;
+}
+
+// a dword [base + i*4 + disp] with an invariant base
+bool Vectorizer::address(const std::shared_ptr<Register>& r, bool store) {
+    auto a = std::dynamic_pointer_cast<Address>(r);
+    if (!a || a->size != 4 || !Operands::virtual_register(a->base) || !Operands::virtual_register(a->index) || a->scale != 4
+        || operands.id(a->index->name) != iv){
+        return false;
+    }
+    int base = operands.id(a->base->name);
+    if (kind[base] != Kind::Invariant){
+        return false;
+    }
+    accesses.push_back({base, a->disp, store});
+    return true;
+}
+
+// the second operand of instruction k, a register or an immediate, never i or a partial sum already summed
+bool Vectorizer::source(size_t k, Kind& source_kind, int& source_id) {
+    auto& i = instructions[k];
+    long value;
+    if (i->registers.size() == 1){
+        if (!Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(i)->value, value)){
+            return false;
+        }
+        immediates.insert(value);
+        source_kind = Kind::Invariant;
+        source_id = -1;
+        return true;
+    }
+    if (!Operands::virtual_register(i->registers[1]) || i->registers[1]->size < 4){
+        return false;
+    }
+    source_id = operands.id(i->registers[1]->name);
+    source_kind = kind[source_id];
+    if (source_id == iv || source_kind == Kind::Summed){
+        return false;
+    }
+    if (source_kind == Kind::Invariant){
+        broadcasts.insert(source_id);
+    }
+    return true;
+}
+
+// the operand of a lea, base + index*scale + disp of lane values, never i or a partial sum
+bool Vectorizer::combination(const std::shared_ptr<Register>& r) {
+    auto a = std::dynamic_pointer_cast<Address>(r);
+    if (!a){
+        return false;
+    }
+    for (auto& term : {a->base, a->index}){
+        if (!term){
+            continue;
+        }
+        if (!Operands::virtual_register(term) || term->size != 8){
+            return false;
+        }
+        int id = operands.id(term->name);
+        if (id == iv || (kind[id] != Kind::Vector && kind[id] != Kind::Invariant)){
+            return false;
+        }
+        if (kind[id] == Kind::Invariant){
+            broadcasts.insert(id);
+        }
+    }
+    if (a->disp != 0){
+        immediates.insert(a->disp);
+    }
+    return true;
+}
+
+// r gets a value of its own, which must not drop a partial sum
+bool Vectorizer::define(int r) {
+    if (kind[r] == Kind::Sum || r == iv){
+        return false;
+    }
+    kind[r] = Kind::Vector;
+    return true;
+}
+
+bool Vectorizer::classify() {
+    int count = operands.count;
+    std::vector<bool> assigned(count, false);
+    std::vector<bool> outside(count, false);
+    std::vector<int> assignments(count, 0);
+    object.assign(count, false);
+    size_t loop_begin = cfg.blocks[loop.header]->begin;
+    size_t loop_end = cfg.blocks[loop.header + 1]->end;
+    for (size_t k = 0; k < instructions.size(); k++){
+        bool inside = k >= loop_begin && k < loop_end;
+        int r = operands.assigned[k];
+        if (r != -1){
+            assigned[r] = assigned[r] || inside;
+            object[r] = ++assignments[r] == 1 && instructions[k]->opcode == "allocate";
+        }
+        for (int m : operands.mentioned[k]){
+            outside[m] = outside[m] || !inside;
+        }
+    }
+
+    kind.assign(count, Kind::Unseen);
+    owner.assign(count, -1);
+    last.assign(count, 0);
+    if (bound != -1 && assigned[bound]){
+        return false;
+    }
+    for (size_t k = begin; k < end; k++){
+        for (int m : operands.mentioned[k]){
+            last[m] = k;
+            if (kind[m] != Kind::Unseen || m == iv){
+                continue;
+            }
+            // registers read before the body assigns them carry a value from the last iteration, only sums may
+            if (!assigned[m]){
+                kind[m] = Kind::Invariant;
+            }
+            else if (operands.reads(k, m)){
+                kind[m] = Kind::Sum;
+                owner[m] = m;
+                reductions.push_back(m);
+            }
+            else if (outside[m]){
+                return false;
+            }
+        }
+
+        auto& i = instructions[k];
+        std::string opcode = CFG::trimmed(i->opcode);
+        if (!std::dynamic_pointer_cast<BasicInstruction>(i) || i->registers.empty() || i->registers.size() > 2){
+            return false;
+        }
+        Kind source_kind = Kind::Unseen;
+        int s = -1;
+        if (opcode == "mov" && std::dynamic_pointer_cast<Address>(i->registers[0])){
+            if (!address(i->registers[0], true) || !source(k, source_kind, s) || source_kind == Kind::Sum){
+                return false;
+            }
+            continue;
+        }
+        if (!Operands::virtual_register(i->registers[0]) || i->registers[0]->size != 8){
+            return false;
+        }
+        int d = operands.id(i->registers[0]->name);
+        if (d == iv){
+            return false;
+        }
+
+        if (opcode == "movsxd" && std::dynamic_pointer_cast<Address>(i->registers[1])){
+            if (!address(i->registers[1], false) || !define(d)){
+                return false;
+            }
+        }
+        else if (opcode == "lea"){
+            if (!combination(i->registers[1]) || !define(d)){
+                return false;
+            }
+        }
+        // lanes are dwords, sign extending one from its low dword copies it
+        else if (opcode == "mov" || opcode == "movsxd"){
+            if (!source(k, source_kind, s)){
+                return false;
+            }
+            if (source_kind == Kind::Sum && d != s){
+                // the partial sum moves on to d
+                if (kind[d] == Kind::Sum){
+                    return false;
+                }
+                kind[d] = Kind::Sum;
+                owner[d] = owner[s];
+                kind[s] = Kind::Summed;
+            }
+            else if (source_kind != Kind::Sum && !define(d)){
+                return false;
+            }
+        }
+        else if (opcode == "add" || opcode == "sub" || opcode == "imul" || opcode == "and" || opcode == "or" || opcode == "xor"){
+            if (!source(k, source_kind, s) || kind[d] == Kind::Summed || kind[d] == Kind::Unseen || (kind[d] == Kind::Sum && s == d)){
+                return false;
+            }
+            // sums only grow by what is added or subtracted, a sum added to a value continues in it
+            if (kind[d] == Kind::Sum && (source_kind == Kind::Sum || (opcode != "add" && opcode != "sub"))){
+                return false;
+            }
+            if (source_kind == Kind::Sum){
+                if (opcode != "add"){
+                    return false;
+                }
+                kind[d] = Kind::Sum;
+                owner[d] = owner[s];
+                kind[s] = Kind::Summed;
+            }
+        }
+        else if (opcode == "shl"){
+            long shift;
+            if (i->registers.size() != 1 || !Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(i)->value, shift)
+                || shift < 0 || shift > 31 || kind[d] != Kind::Vector){
+                return false;
+            }
+        }
+        else if (opcode == "neg"){
+            if (i->registers.size() != 1 || kind[d] != Kind::Vector){
+                return false;
+            }
+        }
+        else{
+            return false;
+        }
+    }
+
+    // every partial sum is back in its reduction register, which is where the sum leaves the loop
+    for (int r = 0; r < count; r++){
+        if ((kind[r] == Kind::Sum) != (owner[r] == r)){
+            return false;
+        }
+    }
+    if (accesses.empty() && reductions.empty()){
+        return false;
+    }
+
+    // lanes of one vector iteration must not see each other's stores, so accesses to one array are a whole
+    // vector apart or at the same element, other arrays are compared at run time
+    for (auto& store : accesses){
+        for (auto& other : accesses){
+            long delta = other.disp - store.disp;
+            if (store.store && store.base == other.base && delta != 0 && std::abs(delta) < 4 * lanes){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// vector register of the second operand of instruction k
+int Vectorizer::operand(size_t k) {
+    auto& i = instructions[k];
+    if (i->registers.size() == 1){
+        long value;
+        Constants::immediate(std::dynamic_pointer_cast<BasicInstruction>(i)->value, value);
+        return immediate_xmm[value];
+    }
+    return xmm[operands.id(i->registers[1]->name)];
+}
+
+// the vector form of body instruction k, false when the vector registers ran out
+bool Vectorizer::translate(size_t k) {
+    auto& i = instructions[k];
+    std::string opcode = CFG::trimmed(i->opcode);
+    int width = target.vector_width();
+
+    if (auto a = std::dynamic_pointer_cast<Address>(i->registers[0])){
+        emit(avx ? "vmovdqu" : "movdqu", {a->sized(width), vector(operand(k))});
+        return true;
+    }
+    int d = operands.id(i->registers[0]->name);
+    if (xmm[d] == -1 && (xmm[d] = take()) == -1){
+        return false;
+    }
+    if (opcode == "movsxd" && std::dynamic_pointer_cast<Address>(i->registers[1])){
+        emit(avx ? "vmovdqu" : "movdqu", {vector(xmm[d]), std::dynamic_pointer_cast<Address>(i->registers[1])->sized(width)});
+        return true;
+    }
+    if (opcode == "lea"){
+        // the index is scaled apart, it may be the destination
+        auto a = std::dynamic_pointer_cast<Address>(i->registers[1]);
+        int base = xmm[operands.id(a->base->name)];
+        int index = -1;
+        if (a->index){
+            if ((index = take()) == -1){
+                return false;
+            }
+            copy(index, xmm[operands.id(a->index->name)]);
+            int shift = a->scale == 8 ? 3 : a->scale == 4 ? 2 : a->scale == 2 ? 1 : 0;
+            if (shift && avx){
+                emit("vpslld", {vector(index), vector(index)}, std::to_string(shift));
+            }
+            else if (shift){
+                emit("pslld", {vector(index)}, std::to_string(shift));
+            }
+        }
+        copy(xmm[d], base);
+        if (index != -1){
+            op("paddd", xmm[d], index);
+            busy[index] = false;
+        }
+        if (a->disp != 0){
+            op("paddd", xmm[d], immediate_xmm[a->disp]);
+        }
+        return true;
+    }
+    if (opcode == "shl"){
+        if (avx){
+            emit("vpslld", {vector(xmm[d]), vector(xmm[d])}, std::dynamic_pointer_cast<BasicInstruction>(i)->value);
+        }
+        else{
+            emit("pslld", {vector(xmm[d])}, std::dynamic_pointer_cast<BasicInstruction>(i)->value);
+        }
+        return true;
+    }
+    if (opcode == "neg"){
+        int zero = take();
+        if (zero == -1){
+            return false;
+        }
+        op("pxor", zero, zero);
+        op("psubd", zero, xmm[d]);
+        copy(xmm[d], zero);
+        busy[zero] = false;
+        return true;
+    }
+
+    int source = operand(k);
+    if (opcode == "mov" || opcode == "movsxd"){
+        copy(xmm[d], source);
+        return true;
+    }
+    if (opcode == "imul" && target.vector == Target::Vector::SSE2){
+        // pmuludq multiplies the even lanes into qwords, the odd ones go through it shifted down
+        int odd = take();
+        int other = take();
+        if (odd == -1 || other == -1){
+            return false;
+        }
+        copy(odd, xmm[d]);
+        copy(other, source);
+        op("pmuludq", xmm[d], source);
+        emit("psrlq", {vector(odd)}, "32");
+        emit("psrlq", {vector(other)}, "32");
+        op("pmuludq", odd, other);
+        emit("pshufd", {vector(xmm[d]), vector(xmm[d])}, "8");
+        emit("pshufd", {vector(odd), vector(odd)}, "8");
+        op("punpckldq", xmm[d], odd);
+        busy[odd] = busy[other] = false;
+        return true;
+    }
+    static const std::map<std::string, std::string> packed = {{"add", "paddd"}, {"sub", "psubd"}, {"imul", "pmulld"},
+                                                              {"and", "pand"}, {"or", "por"}, {"xor", "pxor"}};
+    op(packed.at(opcode), xmm[d], source);
+    return true;
+}
+
+bool Vectorizer::vectorize() {
+    if (!structure() || !classify()){
+        return false;
+    }
+
+    // broadcasts and sums keep their register through the loop, the body's values until their last use
+    busy.assign(vector_registers, false);
+    xmm.assign(operands.count, -1);
+    for (int r : broadcasts){
+        xmm[r] = take();
+    }
+    for (long value : immediates){
+        immediate_xmm[value] = take();
+    }
+    for (int r : reductions){
+        xmm[r] = take();
+    }
+    if (std::count(busy.begin(), busy.end(), true) != int(broadcasts.size() + immediates.size() + reductions.size())){
+        return false;
+    }
+    std::unordered_set<int> pinned(broadcasts.begin(), broadcasts.end());
+    pinned.insert(reductions.begin(), reductions.end());
+
+    std::vector<std::shared_ptr<Instruction>> body;
+    for (size_t k = begin; k < end; k++){
+        if (!translate(k)){
+            return false;
+        }
+        for (int m : operands.mentioned[k]){
+            if (last[m] == k && xmm[m] != -1 && !pinned.count(m)){
+                busy[xmm[m]] = false;
+                xmm[m] = -1;
+            }
+        }
+    }
+    body.swap(code);
+
+    // arrays that might overlap are compared first, the scalar loop runs alone when they are too close
+    std::set<std::tuple<int, int, long>> checked;
+    int next = 0;
+    for (auto& store : accesses){
+        for (auto& other : accesses){
+            if (!store.store || store.base == other.base || (object[store.base] && object[other.base])
+                || !checked.insert({store.base, other.base, other.disp - store.disp}).second){
+                continue;
+            }
+            auto distance = operands.fresh();
+            std::string ok = vector_label(label) + "_ok" + std::to_string(next++);
+            emit("mov", {distance, reg(other.base)});
+            emit("sub", {distance, reg(store.base)});
+            emit("add", {distance}, std::to_string(other.disp - store.disp + 4 * lanes - 1));
+            emit("cmp", {distance}, std::to_string(8 * lanes - 2));
+            code.push_back(std::make_shared<BranchInstruction>("ja", ok));
+            emit("cmp", {distance}, std::to_string(4 * lanes - 1));
+            code.push_back(std::make_shared<BranchInstruction>("jne", label));
+            code.push_back(std::make_shared<Label>(ok, false));
+        }
+    }
+
+    auto limit = operands.fresh();
+    if (bound == -1){
+        emit("mov", {limit}, std::to_string(bound_value));
+    }
+    else{
+        emit("mov", {limit, reg(bound)});
+    }
+    emit("sub", {limit}, std::to_string(lanes - 1));
+    for (int r : broadcasts){
+        broadcast(xmm[r], reg(r, 4));
+    }
+    for (auto& [value, n] : immediate_xmm){
+        auto constant = operands.fresh();
+        emit("mov", {constant}, std::to_string(value));
+        broadcast(n, constant->copy(4));
+    }
+    // lane 0 starts from the sum so far, the others from 0
+    for (int r : reductions){
+        emit(avx ? "vmovd" : "movd", {vector(xmm[r], 16), reg(r, 4)});
+    }
+
+    std::string vector_loop = vector_label(label);
+    code.push_back(std::make_shared<Label>(vector_loop, false));
+    emit("cmp", {reg(iv), limit});
+    code.push_back(std::make_shared<BranchInstruction>(exit_opcode, vector_loop + "_end"));
+    code.insert(code.end(), body.begin(), body.end());
+    emit("add", {reg(iv)}, std::to_string(lanes));
+    code.push_back(std::make_shared<BranchInstruction>("jmp", vector_loop));
+    code.push_back(std::make_shared<Label>(vector_loop + "_end", false));
+
+    // lanes are added pairwise, the int result is sign extended like a dword load
+    for (int r : reductions){
+        int sum = xmm[r];
+        int spare = 0;
+        while (std::any_of(reductions.begin(), reductions.end(), [&](int q) { return xmm[q] == spare; })){
+            spare++;
+        }
+        std::string v = avx ? "v" : "";
+        if (avx){
+            emit("vextracti128", {vector(spare, 16), vector(sum)}, "1");
+            emit("vpaddd", {vector(sum, 16), vector(sum, 16), vector(spare, 16)});
+        }
+        for (std::string shuffle : {"78", "177"}){
+            emit(v + "pshufd", {vector(spare, 16), vector(sum, 16)}, shuffle);
+            if (avx){
+                emit("vpaddd", {vector(sum, 16), vector(sum, 16), vector(spare, 16)});
+            }
+            else{
+                emit("paddd", {vector(sum, 16), vector(spare, 16)});
+            }
+        }
+        emit(v + "movd", {reg(r, 4), vector(sum, 16)});
+        emit("movsxd", {reg(r), reg(r, 4)});
+    }
+    if (avx){
+        emit("vzeroupper", {});
+    }
+
+    size_t at = cfg.blocks[loop.header]->begin;
+    instructions.insert(instructions.begin() + long(at), code.begin(), code.end());
+    return true;
+}
+
+}
+
+bool LoopVectorizer::run(std::vector<std::shared_ptr<Instruction>>& instructions) {
+    // every vectorized loop rebuilds the analyses, loops that do not qualify are not tried again
+    bool changed = false;
+    std::unordered_set<std::string> done;
+    bool vectorized = true;
+    while (vectorized){
+        vectorized = false;
+        CFG cfg = CFG::build(instructions);
+        Operands operands(instructions);
+        Constants constants(instructions, operands);
+        LoopInfo info(cfg);
+        for (int l : info.innermost_first()){
+            auto label = std::dynamic_pointer_cast<Label>(cfg.blocks[info.loops[l].header]->instructions.front());
+            if (!label || done.count(label->label)){
+                continue;
+            }
+            done.insert(label->label);
+            if (Vectorizer(instructions, operands, constants, cfg, info.loops[l], target).vectorize()){
+                done.insert(Vectorizer::vector_label(label->label));
+                vectorized = changed = true;
+                break;
+            }
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,36 @@
+//
+// Created by Ryan Senoune on 2025-03-19.
+//
+
+#ifndef COMPILER_VECTORIZER_H
+#define COMPILER_VECTORIZER_H
+
+#include "pass.h"
+#include "dataflow.h"
+#include "loop_info.h"
+#include "target.h"
+
+/*
+ * Vectorization of element-wise int loops
+ *
+ * An innermost loop qualifies when it is the test i < n (or i <= n) and one straight line body stepping
+ * i by one, whose only memory accesses are dword loads and stores [a + i*4 + d] and which computes with
+ * mov, lea, add, sub, imul, and, or, xor, shl and neg. Every register of the body then holds one int per
+ * lane. A register summed into (s = s + x) keeps a partial sum per lane, added up after the loop.
+ *
+ * The vector loop runs in front of the original one while a whole vector of iterations is left, the
+ * original loop finishes the rest. Arrays that may overlap are compared at run time, only the original
+ * loop runs when they are too close. Vector registers are assigned here: xmm0-xmm14, or ymm with AVX2,
+ * xmm15 is left to struct copies.
+ */
+class LoopVectorizer : public Pass {
+public:
+    explicit LoopVectorizer(Target target) : target(std::move(target)) {}
+
+    bool run(std::vector<std::shared_ptr<Instruction>>& instructions) override;
+
+private:
+    Target target;
+};
+
+#endif //COMPILER_VECTORIZER_H
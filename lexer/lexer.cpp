@@ -2,7 +2,7 @@
 #include <iostream>
 #include <unordered_set>
 
-std::unordered_set<char> singleCharToken = {'{','}','(',')','[',']',';',',','%',' ','.','+','-','*'};
+const std::unordered_set<char> singleCharToken = {'{','}','(',')','[',']',';',',','%',' ','.','+','-','*'};
 
 Lexer::Lexer(const std::string& source_code) : source_code(source_code){}
 
@@ -4,7 +4,7 @@
 
 #include "token.h"
 
-std::unordered_map<TokenType, std::string> tokenNames = {
+const std::unordered_map<TokenType, std::string> tokenNames = {
 {TokenType::IDENTIFIER, "Identifier"}, {TokenType::ASSIGN, "="},
 {TokenType::LBRA, "Left Brace"}, {TokenType::RBRA, "Right Brace"},
 {TokenType::LPAR, "Left Parenthesis"}, {TokenType::RPAR, "Right Parenthesis"},
@@ -29,7 +29,7 @@ std::unordered_map<TokenType, std::string> tokenNames = {
 {TokenType::COMMENT, "Comment"}, {TokenType::NOT, "!"}
 };
 
-std::unordered_map<std::string, TokenType> tokenMap = {
+const std::unordered_map<std::string, TokenType> tokenMap = {
         {"=", TokenType::ASSIGN},
         {"{", TokenType::LBRA}, {"}", TokenType::RBRA},
         {"(", TokenType::LPAR}, {")", TokenType::RPAR},
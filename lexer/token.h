@@ -18,9 +18,9 @@ enum class TokenType {
 
 using TT = TokenType;
 
-extern std::unordered_map<TokenType, std::string> tokenNames;
+extern const std::unordered_map<TokenType, std::string> tokenNames;
 
-extern std::unordered_map<std::string, TokenType> tokenMap;
+extern const std::unordered_map<std::string, TokenType> tokenMap;
 
 std::string getTokenName(TokenType tokenType);
 
@@ -2,13 +2,14 @@
 #include <sstream>
 #include <iostream>
 #include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
 #include "parser/parser.h"
-#include "semantic/name_analysis.h"
-#include "semantic/type_analysis.h"
-#include "ir/instruction_gen.h"
-#include "ir/reg_alloc.h"
-#include "x86/code_gen.h"
-#include "ir/ir_printer.h"
+#include "driver/options.h"
+#include "driver/compilation.h"
+#include "util/thread_pool.h"
 
 void printTokens(Lexer& lexer){
     std::shared_ptr<Token> token = lexer.nextToken();
@@ -25,88 +26,201 @@ void printTokens(Lexer& lexer){
 }
 
 
-int main(int argc, char *argv[]) {
+std::string read_file(const std::string& path, bool& found){
+    std::ifstream file(path);
+    found = bool(file);
 
-    if (argc < 2){
-        std::cerr << "Incorrect Usage, correct usage is..." << std::endl;
-        std::cerr << "compiler <sourcecode.c>" << std::endl;
-        return 1;
-    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// file name without directory and extension, used to name per-file outputs
+std::string output_stem(const std::string& path){
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
 
-    std::ifstream file(argv[1]);
-    std::string content;
 
-    if (file){
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        content = buffer.str();
+int main(int argc, char *argv[]) {
+
+    Options options;
+    try{
+        options = parse_options(argc, argv);
     }
-    else{
-        std::cerr << "Source code file not found" << std::endl;
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    Lexer lexer(content);
+    if (options.inputs.empty()){
+        std::cerr << "Incorrect Usage, correct usage is..." << std::endl;
+        std::cerr << "compiler <sourcecode.c>... [-j N]" << std::endl;
+        return 1;
+    }
 
-    if (argc > 2 && strcmp(argv[2],"-lexer") == 0){
-        try{
-            printTokens(lexer);
-            return 0;
-        }
-        catch(const std::exception& e) {
-            std::cerr << e.what() << std::endl;
-            return 1;
+    // several inputs write <stem>.asm side by side, two of them must not write the same file
+    if (options.inputs.size() > 1){
+        std::unordered_map<std::string, std::string> writers;
+        for (auto& input : options.inputs){
+            auto [it, added] = writers.emplace(output_stem(input), input);
+            if (!added){
+                std::cerr << "Inputs " << it->second << " and " << input << " would both write " << it->first << ".asm" << std::endl;
+                return 1;
+            }
         }
+    }
 
+    std::unique_ptr<TimeProfiler> profiler;
+    if (options.time_report || !options.time_trace.empty()){
+        profiler = std::make_unique<TimeProfiler>();
     }
 
-    Parser parser(lexer);
-    std::shared_ptr<Program> program;
+    std::unique_ptr<PassManager> passes;
     try{
-        program = parser.program();
+        passes = std::make_unique<PassManager>(options.custom_passes ? options.passes : PassManager::preset(options.opt_level), options.target);
+
+        // a pass name is a stage only when it is in the pipeline
+        std::vector<std::string> stages = {"gen"};
+        stages.insert(stages.end(), passes->pipeline().begin(), passes->pipeline().end());
+        stages.insert(stages.end(), {"opt", "alloc", "all"});
+        for (auto& stage : options.dump_ir){
+            if (std::find(stages.begin(), stages.end(), stage) == stages.end()){
+                std::string names;
+                for (auto& s : stages){
+                    names += (names.empty() ? "" : ", ") + s;
+                }
+                throw std::invalid_argument("Unknown IR stage '" + stage + "', stages are " + names);
+            }
+        }
     }
     catch(const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    if (argc > 2 && strcmp(argv[2],"-ast") == 0){
-        PrintVisitor p;
-        program->accept(p);
-        return 0;
+    StdLibrary std_library(options.std_path, profiler.get());
+    std::unique_ptr<CompileCache> cache;
+    if (!options.cache_dir.empty()){
+        cache = std::make_unique<CompileCache>(options.cache_dir);
     }
 
-    try{
-        program->addStandardLibrary();
+    if (options.print_lexer || options.print_ast){
+        for (auto& input : options.inputs){
+            bool found;
+            std::string content = read_file(input, found);
+            if (!found){
+                std::cerr << "Source code file not found" << std::endl;
+                return 1;
+            }
+
+            Lexer lexer(content);
+
+            try{
+                if (options.print_lexer){
+                    printTokens(lexer);
+                    continue;
+                }
+
+                Parser parser(lexer, std_library);
+                std::shared_ptr<Program> program = parser.program();
+                PrintVisitor p;
+                program->accept(p);
+            }
+            catch(const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
 
-        NameAnalysis n;
-        program->accept(n);
+    std::unique_ptr<FunctionCache> function_cache;
+    if (options.watch || !options.cache_dir.empty()){
+        function_cache = std::make_unique<FunctionCache>(options.cache_dir);
+    }
 
-        TypeAnalysis t;
-        program->accept(t);
+    // translation units and the functions inside them share one pool
+    ThreadPool pool(options.jobs);
 
-        InstructionGen i;
-        program->accept(i);
-        IRPrinter::print(i.instructions, "ir.txt");
+    auto compile = [&](const std::vector<std::string>& inputs) {
+        // a single input keeps the historical output.asm name
+        std::vector<std::unique_ptr<Compilation>> compilations;
+        for (auto& input : inputs){
+            std::string stem = options.inputs.size() > 1 ? output_stem(input) : "";
+            compilations.push_back(std::make_unique<Compilation>(input, stem, options, pool, std_library, cache.get(), function_cache.get(), passes.get(), profiler.get()));
+        }
 
-        RegAlloc r;
-        std::unordered_map<std::string, std::string> reg_alloc = r.naive_reg_alloc(i.instructions);
+        TaskGroup group;
+        for (auto& c : compilations){
+            Compilation* compilation = c.get();
+            pool.submit(group, [compilation] { compilation->run(); });
+        }
+        pool.wait(group);
+
+        // report in command line order so diagnostics don't depend on scheduling
+        int status = 0;
+        for (auto& c : compilations){
+            if (!c->diagnostics.empty()){
+                if (options.inputs.size() > 1){
+                    std::cerr << c->input << ": ";
+                }
+                std::cerr << c->diagnostics << std::endl;
+                status = 1;
+            }
+            else if (options.watch){
+                std::cout << c->input << ": " << c->regenerated << "/" << c->functions << " functions regenerated" << std::endl;
+            }
+        }
 
-        IRPrinter::print(i.instructions, "ir2.txt");
+        if (profiler){
+            if (options.time_report){
+                std::cerr << profiler->report();
+                if (!passes->pipeline().empty()){
+                    std::cerr << passes->report();
+                }
+            }
+            if (!options.time_trace.empty()){
+                std::ofstream(options.time_trace) << profiler->trace();
+            }
+            profiler->clear();
+            passes->clear();
+        }
+        return status;
+    };
 
-        CodeGen c("output.asm", std::move(i.instructions), std::move(reg_alloc));
-        c.generate();
+    int status = compile(options.inputs);
 
-    }
-    catch(const std::exception& e) {
-        std::cerr << e.what() << std::endl;
-        return 1;
+    if (options.cache_stats){
+        std::cout << (cache ? cache->stats() : "cache: disabled") << std::endl;
     }
 
+    if (!options.watch){
+        return status;
+    }
 
+    // the std library and function cache stay in memory, so a change only costs its dirty functions
+    std::unordered_map<std::string, std::filesystem::file_time_type> modified;
+    for (auto& input : options.inputs){
+        std::error_code error;
+        modified[input] = std::filesystem::last_write_time(input, error);
+    }
 
+    while (true){
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        std::vector<std::string> changed;
+        for (auto& input : options.inputs){
+            std::error_code error;
+            auto time = std::filesystem::last_write_time(input, error);
+            if (!error && time != modified[input]){
+                modified[input] = time;
+                changed.push_back(input);
+            }
+        }
 
-    return 0;
+        if (!changed.empty()){
+            compile(changed);
+        }
+    }
 }
-
-
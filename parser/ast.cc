@@ -23,6 +23,99 @@ std::string Type::str() {
     return oss.str();
 }
 
+int Type::storage_size() const {
+    int size;
+    if (pointerCount > (int) arraySize.size()){
+        size = 8;
+    }
+    else{
+        switch (token->token_type) {
+            case TT::INT:
+                size = 4;
+                break;
+            case TT::CHAR:
+                size = 1;
+                break;
+            case TT::STRUCT:
+                size = symbol ? std::dynamic_pointer_cast<StructDecl>(symbol->decl)->size : 0;
+                break;
+            default:
+                size = 0;
+                break;
+        }
+    }
+
+    for (int n : arraySize){
+        // an array argument without a size is a pointer
+        if (n < 0){
+            return 8;
+        }
+        size *= n;
+    }
+    return size;
+}
+
+int Type::alignment() const {
+    if (!arraySize.empty() && arraySize[0] < 0){
+        return 8;
+    }
+    if (pointerCount > (int) arraySize.size()){
+        return 8;
+    }
+    switch (token->token_type) {
+        case TT::INT:
+            return 4;
+        case TT::STRUCT:
+            return symbol ? std::dynamic_pointer_cast<StructDecl>(symbol->decl)->alignment : 1;
+        default:
+            return 1;
+    }
+}
+
+std::string declaration(std::shared_ptr<Type> type, const std::string& name) {
+    // array dimensions are counted in pointerCount, print them back as brackets
+    Type base = *type;
+    base.pointerCount -= type->arraySize.size();
+
+    std::string s = base.str() + " " + name;
+    for (int size : type->arraySize){
+        s += "[" + (size < 0 ? "" : std::to_string(size)) + "]";
+    }
+    return s;
+}
+
+std::string declaration(std::shared_ptr<Decl> d) {
+    std::shared_ptr<Type> type;
+    std::string name;
+    std::vector<std::shared_ptr<VarDecl>> args;
+
+    if (auto f = std::dynamic_pointer_cast<FuncDecl>(d)){
+        type = f->type, name = f->name, args = f->args;
+    }
+    else if (auto p = std::dynamic_pointer_cast<FunProto>(d)){
+        type = p->type, name = p->name, args = p->args;
+    }
+    else if (auto v = std::dynamic_pointer_cast<VarDecl>(d)){
+        return declaration(v->type, v->name) + ";\n";
+    }
+    else if (auto s = std::dynamic_pointer_cast<StructDecl>(d)){
+        std::string text = "struct " + s->name + " {\n";
+        for (auto& field : s->varDecls){
+            text += "    " + declaration(field->type, field->name) + ";\n";
+        }
+        return text + "};\n";
+    }
+    else{
+        return "";
+    }
+
+    std::string text = type->str() + " " + name + "(";
+    for (int i = 0; i < args.size(); i++){
+        text += (i ? ", " : "") + declaration(args[i]->type, args[i]->name);
+    }
+    return text + ");\n";
+}
+
 void PrintVisitor::incr() {
     indent += space;
 }
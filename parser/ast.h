@@ -64,7 +64,7 @@ public:
     int pointerCount;
     std::vector<int> arraySize;
     std::shared_ptr<Symbol> symbol;
-    int size;
+    int size = 0; // sizeof, set by the semantic analysis
 
     Type(std::shared_ptr<Token> token) : token(token), pointerCount(0), arraySize(0) {}
 
@@ -81,6 +81,20 @@ public:
 
     std::string str();
 
+    // plain scalar of the given type, is(TT::INT) is str() == "int" without building the string
+    bool is(TT t) const {
+        return token->token_type == t && pointerCount == 0;
+    }
+
+    // SysV sizes and alignments (char 1, int 4, pointer 8), a struct type needs its symbol resolved
+    int storage_size() const;
+    int alignment() const;
+
+    // arrays of known size and structs live in memory and are used through their address
+    bool is_aggregate() const {
+        return (token->token_type == TT::STRUCT && pointerCount == 0) || (!arraySize.empty() && arraySize[0] >= 0);
+    }
+
     void accept(Visitor<void>& visitor){
         visitor.visit(shared_from_this());
     }
@@ -243,6 +257,7 @@ struct VarDecl : Decl, Stmt, std::enable_shared_from_this<VarDecl> {
     std::shared_ptr<Type> type;
     std::string name;
     bool is_local;
+    bool address_taken = false; // a scalar whose address is taken is kept in memory
     int offset = 0;
     VarDecl(std::shared_ptr<Type> t, std::string n, bool is_local) : name(n), type(std::move(t)), is_local(is_local) {}
 
@@ -262,7 +277,8 @@ struct VarDecl : Decl, Stmt, std::enable_shared_from_this<VarDecl> {
 struct StructDecl : Decl, std::enable_shared_from_this<StructDecl> {
     std::vector<std::shared_ptr<VarDecl>> varDecls;
     std::string name;
-    int size;
+    int size = 0;
+    int alignment = 1;
     StructDecl(std::string& n) : name(n) {}
     void accept(Visitor<void>& visitor){
         visitor.visit(shared_from_this());
@@ -387,6 +403,8 @@ struct FuncDecl : Decl, std::enable_shared_from_this<FuncDecl> {
     std::vector<std::shared_ptr<VarDecl>> args;
     std::shared_ptr<Block> block;
     int arg_offset = 0;
+    // body unchanged since a previous compile, semantic analysis and code generation reuse that result
+    bool unchanged = false;
     FuncDecl(std::shared_ptr<Type> t, const char *n, std::vector<std::shared_ptr<VarDecl>> a) : name(n), type(t), args(a), block(std::make_shared<Block>()) {}
     FuncDecl(std::shared_ptr<Type> t, std::string& n, std::vector<std::shared_ptr<VarDecl>> a, std::shared_ptr<Block> b) : name(n), type(std::move(t)), args(std::move(a)), block(std::move(b)) {}
     void accept(Visitor<void>& visitor){
@@ -456,6 +474,10 @@ struct Program : public std::enable_shared_from_this<Program>{
     }
 };
 
+// C source text of a declaration: prototype for functions, full body for structs
+std::string declaration(std::shared_ptr<Decl> d);
+std::string declaration(std::shared_ptr<Type> type, const std::string& name);
+
 class PrintVisitor : public Visitor<void>{
 
     std::string space = "    ";
@@ -0,0 +1,31 @@
+//
+// Created by Ryan Senoune on 2025-03-04.
+//
+
+#ifndef COMPILER_MODULE_H
+#define COMPILER_MODULE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*
+ * A precompiled std module (#include <name>)
+ * header holds the declarations in C syntax, assembly the already generated function bodies
+ */
+struct StdModule {
+    std::string name;
+    uint64_t hash = 0; // hash of the module source
+    std::string header;
+    std::string assembly;
+};
+
+class ModuleLoader {
+public:
+    virtual ~ModuleLoader() = default;
+
+    // returns nullptr if the module does not exist
+    virtual std::shared_ptr<const StdModule> load(const std::string& name) = 0;
+};
+
+#endif //COMPILER_MODULE_H
@@ -4,7 +4,7 @@
 
 #include "parser.h"
 
-Parser::Parser(Lexer &lexer):lexer(lexer) {}
+Parser::Parser(Lexer &lexer, ModuleLoader& modules):lexer(lexer), modules(modules) {}
 
 std::shared_ptr<Program> Parser::program(){
 
@@ -14,6 +14,7 @@ std::shared_ptr<Program> Parser::program(){
         std::vector<std::shared_ptr<Decl>> ext = include();
         decls.insert(decls.end(), ext.begin(), ext.end());
     }
+    included_decls = decls.size();
 
     while (!accept(TT::END_OF_FILE)){
         decls.push_back(decl());
@@ -22,34 +23,31 @@ std::shared_ptr<Program> Parser::program(){
     return std::make_shared<Program>(std::move(decls));
 }
 
+/*
+ * Std modules come precompiled, only their declarations are parsed here
+ * The function bodies are already assembly and get appended by the driver
+ */
 std::vector<std::shared_ptr<Decl>> Parser::include(){
-    std::string f = consume(TT::INCLUDE, "Expected #include directive")->value;
-    std::string path = "../std/" + f + ".c";
-    std::ifstream file(path);
-    std::string content;
-
-    if (file){
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        content = buffer.str();
-
-        Lexer lexer(content);
-
-        Parser parser(lexer);
-        std::shared_ptr<Program> program;
-        try{
-            program = parser.program();
-        }
-        catch(const std::exception& e) {
-            std::cerr << e.what() << std::endl;
-        }
+    std::shared_ptr<Token> token = consume(TT::INCLUDE, "Expected #include directive");
+    std::shared_ptr<const StdModule> module = modules.load(token->value);
 
-        return program->decls;
-
-    }
-    else{
+    if (!module){
         throw parsing_exception("Invalid include path", peek(0));
     }
+
+    for (auto& m : includes){
+        if (m->name == module->name){
+            return {};
+        }
+    }
+    includes.push_back(module);
+
+    Lexer lexer(module->header);
+    Parser parser(lexer, modules);
+    std::shared_ptr<Program> program = parser.program();
+    includes.insert(includes.end(), parser.includes.begin(), parser.includes.end());
+
+    return program->decls;
 }
 
 std::shared_ptr<Token> Parser::consume(TT expected, const std::string& message){
@@ -98,6 +96,12 @@ bool Parser::accept(TT expected, int i){
     return peek(i)->token_type == expected;
 }
 
+void Parser::tokenize() {
+    while (buffer.empty() || buffer.back()->token_type != TT::END_OF_FILE){
+        buffer.push_back(lexer.nextToken());
+    }
+}
+
 std::shared_ptr<Token> Parser::peek(int i) {
     for(int j=0;j<i - int(buffer.size()) + 1; j++){
         buffer.push_back(lexer.nextToken());
@@ -8,6 +8,7 @@
 #include "../lexer/lexer.h"
 #include "ast.h"
 #include "parsing_exception.h"
+#include "module.h"
 #include <deque>
 #include <vector>
 #include <fstream>
@@ -15,7 +16,7 @@
 class Parser{
 
 public:
-    Parser(Lexer& lexer);
+    Parser(Lexer& lexer, ModuleLoader& modules);
 
     std::shared_ptr<Type> type();
     std::shared_ptr<Expr> access(std::shared_ptr<Expr> prev);
@@ -47,10 +48,18 @@ public:
     bool accept(std::vector<TT> expected);
     bool accept(std::vector<TT> expected, int i);
     std::shared_ptr<Token> peek(int amount);
+    // lexes the rest of the input up front, only done to time lexing on its own
+    void tokenize();
+
+    // std modules pulled in by #include, in include order
+    std::vector<std::shared_ptr<const StdModule>> includes;
+    // number of leading program decls that came from includes
+    size_t included_decls = 0;
 
 
 private:
     Lexer& lexer;
+    ModuleLoader& modules;
     std::deque<std::shared_ptr<Token>> buffer;
 };
 
@@ -0,0 +1,201 @@
+//
+// Created by Ryan Senoune on 2025-03-08.
+//
+
+#include "fingerprint.h"
+
+Fingerprint::Fingerprint(std::shared_ptr<Program> program, const Inliner* inliner) : program(program), inliner(inliner) {
+    for (int i = 0; i < program->decls.size(); i++){
+        auto d = program->decls[i];
+        if (auto f = std::dynamic_pointer_cast<FuncDecl>(d)){
+            decls[f->name].push_back(i);
+        }
+        else if (auto p = std::dynamic_pointer_cast<FunProto>(d)){
+            decls[p->name].push_back(i);
+        }
+        else if (auto v = std::dynamic_pointer_cast<VarDecl>(d)){
+            decls[v->name].push_back(i);
+        }
+        else if (auto s = std::dynamic_pointer_cast<StructDecl>(d)){
+            structs[s->name] = i;
+        }
+    }
+}
+
+std::string Fingerprint::of(std::shared_ptr<FuncDecl> f) {
+    hash = Hash();
+    names.clear();
+    struct_names.clear();
+    inlined.clear();
+
+    f->accept(*this);
+
+    int position = 0;
+    while (program->decls[position] != f){
+        position++;
+    }
+
+    // every function gets a register for each global, so all of them are dependencies
+    for (int i = 0; i < program->decls.size(); i++){
+        if (auto v = std::dynamic_pointer_cast<VarDecl>(program->decls[i])){
+            hash.add("global").add(declaration(v)).add(uint64_t(i < position));
+            v->type->accept(*this);
+        }
+    }
+
+    // identifiers may be locals, only names with a top level declaration matter
+    for (auto& name : names){
+        dependency(name, position);
+    }
+
+    std::set<std::string> seen;
+    for (auto& name : struct_names){
+        struct_dependency(name, position, seen);
+    }
+
+    return hash.hex();
+}
+
+// declarations are resolved in order, so whether a dependency comes first is part of the hash
+void Fingerprint::dependency(const std::string& name, int position) {
+    auto it = decls.find(name);
+    if (it == decls.end()){
+        hash.add("undeclared").add(name);
+        return;
+    }
+    for (int i : it->second){
+        hash.add("decl").add(declaration(program->decls[i])).add(uint64_t(i < position));
+    }
+}
+
+// a struct layout depends on the structs of its fields
+void Fingerprint::struct_dependency(const std::string& name, int position, std::set<std::string>& seen) {
+    if (!seen.insert(name).second){
+        return;
+    }
+
+    auto it = structs.find(name);
+    if (it == structs.end()){
+        hash.add("undeclared struct").add(name);
+        return;
+    }
+
+    auto s = std::dynamic_pointer_cast<StructDecl>(program->decls[it->second]);
+    hash.add("struct").add(declaration(s)).add(uint64_t(it->second < position));
+    for (auto& field : s->varDecls){
+        if (field->type->token->token_type == TT::STRUCT){
+            struct_dependency(field->type->name, position, seen);
+        }
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<FuncDecl> func) {
+    hash.add("func").add(declaration(func));
+    for (auto a : func->args){
+        a->accept(*this);
+    }
+    func->block->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Block> block) {
+    hash.add("{").add(uint64_t(block->stmts.size()));
+    for (auto s : block->stmts){
+        s->accept(*this);
+    }
+    hash.add("}");
+}
+
+void Fingerprint::visit(std::shared_ptr<If> i) {
+    hash.add("if").add(uint64_t(i->stmt2.has_value()));
+    i->expr1->accept(*this);
+    i->stmt1->accept(*this);
+    if (i->stmt2.has_value()){
+        i->stmt2->get()->accept(*this);
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<While> w) {
+    hash.add("while");
+    w->expr->accept(*this);
+    w->stmt->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Continue> c) {
+    hash.add("continue");
+}
+
+void Fingerprint::visit(std::shared_ptr<Break> b) {
+    hash.add("break");
+}
+
+void Fingerprint::visit(std::shared_ptr<Return> ret) {
+    hash.add("return").add(uint64_t(ret->expr.has_value()));
+    if (ret->expr.has_value()){
+        ret->expr->get()->accept(*this);
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<VarDecl> varDecl) {
+    hash.add("var").add(declaration(varDecl->type, varDecl->name));
+    varDecl->type->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Type> type) {
+    if (type->token->token_type == TT::STRUCT){
+        struct_names.insert(type->name);
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<Call> call) {
+    hash.add("call").add(call->identifier->value).add(uint64_t(call->args.size()));
+    names.insert(call->identifier->value);
+    for (auto a : call->args){
+        a->accept(*this);
+    }
+
+    // the callee's own dependencies are collected with it
+    if (auto f = inliner ? inliner->callee(call) : nullptr; f && inlined.insert(f).second){
+        hash.add("inline");
+        f->accept(*this);
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<Unary> unary) {
+    hash.add("unary").add(uint64_t(unary->op->token_type));
+    unary->expr1->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<TypeCast> typeCast) {
+    hash.add("cast").add(typeCast->typeCast->str());
+    typeCast->typeCast->accept(*this);
+    typeCast->expr1->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Binary> binary) {
+    hash.add("binary").add(uint64_t(binary->op->token_type));
+    binary->expr1->accept(*this);
+    binary->expr2->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Primary> primary) {
+    hash.add("primary").add(uint64_t(primary->token->token_type)).add(primary->token->value);
+    if (primary->token->token_type == TT::IDENTIFIER){
+        names.insert(primary->token->value);
+    }
+}
+
+void Fingerprint::visit(std::shared_ptr<Subscript> subscript) {
+    hash.add("subscript");
+    subscript->array->accept(*this);
+    subscript->index->accept(*this);
+}
+
+void Fingerprint::visit(std::shared_ptr<Member> member) {
+    hash.add("member").add(member->member);
+    member->structure->accept(*this);
+}
+
+// only reached through a FuncDecl, top level declarations are hashed as dependencies
+void Fingerprint::visit(std::shared_ptr<Program> program) {}
+void Fingerprint::visit(std::shared_ptr<FunProto> funProto) {}
+void Fingerprint::visit(std::shared_ptr<StructDecl> structDecl) {}
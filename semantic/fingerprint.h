@@ -0,0 +1,61 @@
+//
+// Created by Ryan Senoune on 2025-03-08.
+//
+
+#ifndef COMPILER_FINGERPRINT_H
+#define COMPILER_FINGERPRINT_H
+
+#include <set>
+#include "../parser/ast.h"
+#include "../util/hash.h"
+#include "../ir/inliner.h"
+
+/*
+ * Hash of everything the code of a function depends on, computed before semantic analysis:
+ * its own AST plus the declarations of the functions, globals and structs it references.
+ * Equal fingerprints mean the function analyses and compiles to the same code, so a body
+ * edit only dirties that function and a signature or struct change dirties its users.
+ * The body of a callee that is inlined is part of its callers' code, so it is hashed with them
+ */
+class Fingerprint : public Visitor<void> {
+public:
+    explicit Fingerprint(std::shared_ptr<Program> program, const Inliner* inliner = nullptr);
+
+    std::string of(std::shared_ptr<FuncDecl> f);
+
+private:
+    std::shared_ptr<Program> program;
+    const Inliner* inliner;
+    std::unordered_map<std::string, std::vector<int>> decls;
+    std::unordered_map<std::string, int> structs;
+
+    Hash hash;
+    std::set<std::string> names;
+    std::set<std::string> struct_names;
+    std::set<std::shared_ptr<FuncDecl>> inlined;
+
+    void dependency(const std::string& name, int position);
+    void struct_dependency(const std::string& name, int position, std::set<std::string>& seen);
+
+    void visit(std::shared_ptr<Program> program) override;
+    void visit(std::shared_ptr<FuncDecl> func) override;
+    void visit(std::shared_ptr<FunProto> funProto) override;
+    void visit(std::shared_ptr<Block> block) override;
+    void visit(std::shared_ptr<If> i) override;
+    void visit(std::shared_ptr<While> w) override;
+    void visit(std::shared_ptr<Continue> c) override;
+    void visit(std::shared_ptr<Break> b) override;
+    void visit(std::shared_ptr<Return> ret) override;
+    void visit(std::shared_ptr<VarDecl> varDecl) override;
+    void visit(std::shared_ptr<Type> type) override;
+    void visit(std::shared_ptr<Call> call) override;
+    void visit(std::shared_ptr<StructDecl> structDecl) override;
+    void visit(std::shared_ptr<Unary> unary) override;
+    void visit(std::shared_ptr<TypeCast> typeCast) override;
+    void visit(std::shared_ptr<Binary> binary) override;
+    void visit(std::shared_ptr<Primary> primary) override;
+    void visit(std::shared_ptr<Subscript> subscript) override;
+    void visit(std::shared_ptr<Member> member) override;
+};
+
+#endif //COMPILER_FINGERPRINT_H
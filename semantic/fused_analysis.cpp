@@ -0,0 +1,67 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#include "fused_analysis.h"
+
+void FusedAnalysis::visit(std::shared_ptr<Call> call) {
+    NameAnalysis::visit(call);
+    TypeAnalysis::check(call);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<VarDecl> varDecl) {
+    NameAnalysis::visit(varDecl);
+    TypeAnalysis::check(varDecl);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Primary> primary) {
+    NameAnalysis::visit(primary);
+    TypeAnalysis::check(primary);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<StructDecl> structDecl) {
+    NameAnalysis::visit(structDecl);
+    for (auto field : structDecl->varDecls){
+        TypeAnalysis::check(structDecl, field);
+    }
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Unary> unary) {
+    NameAnalysis::visit(unary);
+    TypeAnalysis::check(unary);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Binary> binary) {
+    NameAnalysis::visit(binary);
+    TypeAnalysis::check(binary);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Subscript> subscript) {
+    NameAnalysis::visit(subscript);
+    TypeAnalysis::check(subscript);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Member> member) {
+    NameAnalysis::visit(member);
+    TypeAnalysis::check(member);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<If> i) {
+    NameAnalysis::visit(i);
+    TypeAnalysis::check(i);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<While> w) {
+    NameAnalysis::visit(w);
+    TypeAnalysis::check(w);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<Return> ret) {
+    NameAnalysis::visit(ret);
+    TypeAnalysis::check(ret);
+}
+
+void FusedAnalysis::visit(std::shared_ptr<TypeCast> typeCast) {
+    NameAnalysis::visit(typeCast);
+    TypeAnalysis::check(typeCast);
+}
@@ -0,0 +1,32 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#ifndef COMPILER_FUSED_ANALYSIS_H
+#define COMPILER_FUSED_ANALYSIS_H
+
+#include "name_analysis.h"
+#include "type_analysis.h"
+
+/*
+ * Name and type analysis in a single walk (-fused-analysis)
+ * Every node is resolved by NameAnalysis, whose recursion comes back through this visitor,
+ * and type checked once its children are done, so the annotations are the ones of the two passes
+ * Diagnostics only differ in order when a program has several errors
+ */
+class FusedAnalysis : public NameAnalysis {
+    void visit(std::shared_ptr<Call> call) override;
+    void visit(std::shared_ptr<VarDecl> varDecl) override;
+    void visit(std::shared_ptr<Primary> primary) override;
+    void visit(std::shared_ptr<StructDecl> structDecl) override;
+    void visit(std::shared_ptr<Unary> unary) override;
+    void visit(std::shared_ptr<Binary> binary) override;
+    void visit(std::shared_ptr<Subscript> subscript) override;
+    void visit(std::shared_ptr<Member> member) override;
+    void visit(std::shared_ptr<If> i) override;
+    void visit(std::shared_ptr<While> w) override;
+    void visit(std::shared_ptr<Return> ret) override;
+    void visit(std::shared_ptr<TypeCast> typeCast) override;
+};
+
+#endif //COMPILER_FUSED_ANALYSIS_H
@@ -4,34 +4,17 @@
 
 #include "name_analysis.h"
 
-std::shared_ptr<Symbol> NameAnalysis::get(std::string identifier) {
-    for (int i = scopes.size() - 1; i >= 0; i--) {
-        if (scopes[i].find(identifier) != scopes[i].end()) {
-            return scopes[i][identifier];
-        }
-    }
-    return std::shared_ptr<Symbol>(nullptr);
-}
-
-std::shared_ptr<Symbol> NameAnalysis::get_local(std::string identifier) {
-    if (scopes[scopes.size() - 1].find(identifier) != scopes[scopes.size() - 1].end()) {
-        return scopes[scopes.size() - 1][identifier];
-    }
-    return std::shared_ptr<Symbol>(nullptr);
-}
-
-void NameAnalysis::put(std::string identifier, std::shared_ptr<Symbol> symbol) {
-    scopes[scopes.size() - 1][identifier] = symbol;
-}
-
 int NameAnalysis::align(int offset, int alignment) {
+    if (alignment <= 0){
+        return offset;
+    }
     return offset + ((alignment - (offset % alignment)) % alignment);
 }
 
 void NameAnalysis::visit(std::shared_ptr<FuncDecl> func) {
-    if (get_local(func->name)) {
-        if (get_local(func->name)->type == Symbol::Type::PROTO) {
-            std::shared_ptr<FunProto> funProto = std::dynamic_pointer_cast<FunProto>(get_local(func->name)->decl);
+    if (symbols.get_local(func->name)) {
+        if (symbols.get_local(func->name)->type == Symbol::Type::PROTO) {
+            std::shared_ptr<FunProto> funProto = std::dynamic_pointer_cast<FunProto>(symbols.get_local(func->name)->decl);
 
             if (*(funProto->type) != *(func->type)){
                 throw semantic_exception("Conflicting return type in function '" + func->name + "'", func->type->token);
@@ -47,45 +30,48 @@ void NameAnalysis::visit(std::shared_ptr<FuncDecl> func) {
                 }
             }
 
-            get_local(func->name)->type = Symbol::Type::FUNC;
-            get_local(func->name)->decl = func;
+            symbols.get_local(func->name)->type = Symbol::Type::FUNC;
+            symbols.get_local(func->name)->decl = func;
         } else {
             throw semantic_exception("Identifier '" + func->name + "' has already been declared in the same scope", func->type->token);
         }
     }
     func->type->accept(*this);
     std::shared_ptr<Symbol> funcSymbol = std::make_shared<Symbol>(Symbol::Type::FUNC, func);
-    put(func->name, funcSymbol);
+    symbols.put(func->name, funcSymbol);
     currFunc = funcSymbol;
 
-    scopes.emplace_back();
+    symbols.push_scope();
 
     for (auto a : func->args){
         a->accept(*this);
         a->is_local = true;
     }
-    for (auto s : func->block->stmts){
-        s->accept(*this);
+    // the body of an unchanged function is not compiled again, its signature still is
+    if (!func->unchanged){
+        for (auto s : func->block->stmts){
+            s->accept(*this);
+        }
     }
 
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<FunProto> funProto) {
-    if (get_local(funProto->name)) {
+    if (symbols.get_local(funProto->name)) {
         throw semantic_exception("Function prototype '" + funProto->name + "' has already been declared in the same scope", funProto->type->token);
     }
-    put(funProto->name, std::make_shared<Symbol>(Symbol::Type::PROTO, funProto));
+    symbols.put(funProto->name, std::make_shared<Symbol>(Symbol::Type::PROTO, funProto));
 
-    scopes.emplace_back();
+    symbols.push_scope();
     for (auto a : funProto->args){
         a->accept(*this);
     }
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<Call> call) {
-    std::shared_ptr<Symbol> funcDecl = get(call->identifier->value);
+    std::shared_ptr<Symbol> funcDecl = symbols.get(call->identifier->value);
     if (!funcDecl) {
         throw semantic_exception("Function '" + call->identifier->value + "' is not declared", call->identifier);
     }
@@ -97,16 +83,16 @@ void NameAnalysis::visit(std::shared_ptr<Call> call) {
 }
 
 void NameAnalysis::visit(std::shared_ptr<VarDecl> varDecl) {
-    if (get_local(varDecl->name)) {
+    if (symbols.get_local(varDecl->name)) {
         throw semantic_exception("Identifier '" + varDecl->name + "' has already been declared in the same scope", varDecl->type->token);
     }
     varDecl->type->accept(*this);
-    put(varDecl->name, std::make_shared<Symbol>(Symbol::Type::VAR, varDecl));
+    symbols.put(varDecl->name, std::make_shared<Symbol>(Symbol::Type::VAR, varDecl));
 }
 
 void NameAnalysis::visit(std::shared_ptr<Primary> primary) {
     if (primary->token->token_type == TT::IDENTIFIER) {
-        std::shared_ptr<Symbol> varDecl = get(primary->token->value);
+        std::shared_ptr<Symbol> varDecl = symbols.get(primary->token->value);
         if (!varDecl) {
             throw semantic_exception("Variable '" + primary->token->value + "' is not declared", primary->token);
         }
@@ -115,13 +101,13 @@ void NameAnalysis::visit(std::shared_ptr<Primary> primary) {
 }
 
 void NameAnalysis::visit(std::shared_ptr<StructDecl> structDecl) {
-    if (get(structDecl->name + "$struct")) {
+    if (structs.get(structDecl->name)) {
         throw semantic_exception("Struct '" + structDecl->name + "' has already been declared");
     }
 
-    put(structDecl->name + "$struct", std::make_shared<Symbol>(Symbol::Type::STRUCT, structDecl));
+    structs.put(structDecl->name, std::make_shared<Symbol>(Symbol::Type::STRUCT, structDecl));
 
-    scopes.emplace_back();
+    symbols.push_scope();
     for (auto v : structDecl->varDecls) {
         v->accept(*this);
     }
@@ -133,7 +119,7 @@ void NameAnalysis::visit(std::shared_ptr<StructDecl> structDecl) {
     int offset = 0;
 
     for (auto v : structDecl->varDecls){
-        alignment = v->type->size;
+        alignment = v->type->alignment();
         maxAlignment = std::max(maxAlignment, alignment);
 
         offset = align(offset, alignment);
@@ -143,8 +129,9 @@ void NameAnalysis::visit(std::shared_ptr<StructDecl> structDecl) {
 
     offset = align(offset, maxAlignment);
     structDecl->size = offset;
+    structDecl->alignment = std::max(maxAlignment, 1);
 
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<Unary> unary) {
@@ -170,30 +157,30 @@ void NameAnalysis::visit(std::shared_ptr<TypeCast> typeCast){
 }
 
 void NameAnalysis::visit(std::shared_ptr<Block> block) {
-    scopes.emplace_back();
+    symbols.push_scope();
     for (auto s : block->stmts) {
         s->accept(*this);
     }
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<If> i) {
     i->expr1->accept(*this);
-    scopes.emplace_back();
+    symbols.push_scope();
     i->stmt1->accept(*this);
-    scopes.pop_back();
-    scopes.emplace_back();
+    symbols.pop_scope();
+    symbols.push_scope();
     if (i->stmt2.has_value()){
         i->stmt2->get()->accept(*this);
     }
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<While> w) {
     w->expr->accept(*this);
-    scopes.emplace_back();
+    symbols.push_scope();
     w->stmt->accept(*this);
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<Return> ret) {
@@ -206,45 +193,21 @@ void NameAnalysis::visit(std::shared_ptr<Return> ret) {
 }
 
 void NameAnalysis::visit(std::shared_ptr<Program> program) {
-    scopes.emplace_back();
+    symbols.push_scope();
     for (auto d : program->decls) {
         d->accept(*this);
     }
-    scopes.pop_back();
+    symbols.pop_scope();
 }
 
 void NameAnalysis::visit(std::shared_ptr<Type> t) {
     if (t->token->token_type == TT::STRUCT){
-        for (auto pair : scopes[0]){
-            if (pair.second->type == Symbol::Type::STRUCT && pair.first == t->name + "$struct"){
-                t->symbol = pair.second;
-            }
-        }
+        t->symbol = structs.get(t->name);
         if (!t->symbol)
             throw semantic_exception("Type struct '"+ t->name +"' is not declared", t->token);
     }
 
-    // size of type
-    switch (t->token->token_type) {
-        case TT::INT:
-            t->size = 8;
-            break;
-        case TT::VOID:
-            t->size = 0;
-            break;
-        case TT::CHAR:
-            t->size = 8;
-            break;
-        case TT::STRUCT:
-            t->size = std::dynamic_pointer_cast<StructDecl>(t->symbol->decl)->size;
-            break;
-        default:
-            break;
-    }
-
-    if (t->pointerCount > 0){
-        t->size = 8;
-    }
+    t->size = t->storage_size();
 }
 
 void NameAnalysis::visit(std::shared_ptr<Continue> c) {
@@ -7,15 +7,15 @@
 
 #include "../parser/ast.h"
 #include "semantic_exception.h"
+#include "symbol_table.h"
 
 class NameAnalysis : public Visitor<void> {
-    std::vector<std::unordered_map<std::string, std::shared_ptr<Symbol>>> scopes;
+protected:
+    SymbolTable symbols;
+    // struct tags are a namespace of their own, like in C
+    SymbolTable structs;
     std::shared_ptr<Symbol> currFunc;
 
-    std::shared_ptr<Symbol> get(std::string identifier);
-    std::shared_ptr<Symbol> get_local(std::string identifier);
-    void put(std::string identifier, std::shared_ptr<Symbol> symbol);
-
     int align(int offset, int alignment);
 
     void visit(std::shared_ptr<FuncDecl> func) override;
@@ -0,0 +1,47 @@
+//
+// Created by Ryan Senoune on 2025-03-10.
+//
+
+#include "symbol_table.h"
+
+std::shared_ptr<Symbol> SymbolTable::get(std::string_view name) const {
+    auto it = bindings.find(name);
+    return it == bindings.end() ? nullptr : it->second.symbol;
+}
+
+std::shared_ptr<Symbol> SymbolTable::get_local(std::string_view name) const {
+    auto it = bindings.find(name);
+    return it == bindings.end() || it->second.depth != int(scopes.size()) ? nullptr : it->second.symbol;
+}
+
+void SymbolTable::put(std::string_view name, std::shared_ptr<Symbol> symbol) {
+    auto it = bindings.find(name);
+    if (it == bindings.end()){
+        log.push_back({name, false, {}});
+        bindings.emplace(name, Binding{std::move(symbol), int(scopes.size())});
+        return;
+    }
+
+    log.push_back({name, true, it->second});
+    it->second = Binding{std::move(symbol), int(scopes.size())};
+}
+
+void SymbolTable::push_scope() {
+    scopes.push_back(log.size());
+}
+
+void SymbolTable::pop_scope() {
+    size_t mark = scopes.back();
+    scopes.pop_back();
+
+    while (log.size() > mark){
+        Undo& undo = log.back();
+        if (undo.shadowed){
+            bindings[undo.name] = std::move(undo.previous);
+        }
+        else{
+            bindings.erase(undo.name);
+        }
+        log.pop_back();
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by Ryan Senoune on 2025-03-10.
+//
+
+#ifndef COMPILER_SYMBOL_TABLE_H
+#define COMPILER_SYMBOL_TABLE_H
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../parser/ast.h"
+
+/*
+ * Scoped symbol table, one hash map holding the innermost binding of every name
+ * Shadowed bindings are kept in an undo log and restored when their scope is popped,
+ * so lookups are a single hash probe and pushing or popping a scope allocates nothing
+ * Keys view the names stored in the AST, which outlives the table
+ */
+class SymbolTable {
+public:
+    std::shared_ptr<Symbol> get(std::string_view name) const;
+    // only bindings made in the innermost scope
+    std::shared_ptr<Symbol> get_local(std::string_view name) const;
+    void put(std::string_view name, std::shared_ptr<Symbol> symbol);
+
+    void push_scope();
+    void pop_scope();
+
+private:
+    struct Binding {
+        std::shared_ptr<Symbol> symbol;
+        int depth;
+    };
+
+    struct Undo {
+        std::string_view name;
+        bool shadowed;
+        Binding previous;
+    };
+
+    std::unordered_map<std::string_view, Binding> bindings;
+    std::vector<Undo> log;
+    std::vector<size_t> scopes;
+};
+
+#endif //COMPILER_SYMBOL_TABLE_H
@@ -7,6 +7,10 @@
 
 
 void TypeAnalysis::visit(std::shared_ptr<Primary> p) {
+    check(p);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Primary> p) {
     switch (p->token->token_type) {
         case TT::IDENTIFIER:
             p->type = std::make_shared<Type>(*(std::dynamic_pointer_cast<VarDecl>(p->symbol->decl)->type));
@@ -25,15 +29,20 @@ void TypeAnalysis::visit(std::shared_ptr<Primary> p) {
         default:
             break;
     }
+    p->type->size = p->type->storage_size();
 }
 
 void TypeAnalysis::visit(std::shared_ptr<Unary> u) {
     u->expr1->accept(*this);
+    check(u);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Unary> u) {
     u->type = std::make_shared<Type>(*(u->expr1->type));
     switch (u->op->token_type) {
         case TT::MINUS:
         case TT::NOT:
-            if (u->expr1->type->str() != "int"){
+            if (!u->expr1->type->is(TT::INT)){
                 throw semantic_exception("Invalid unary type '" + u->expr1->type->str() + "' but expected type 'int'",u->op);
             }
             break;
@@ -49,15 +58,23 @@ void TypeAnalysis::visit(std::shared_ptr<Unary> u) {
                 throw semantic_exception("Cannot reference non-lvalue expression", u->op);
             }
             u->type->pointerCount++;
+            if (auto p = std::dynamic_pointer_cast<Primary>(u->expr1)){
+                std::dynamic_pointer_cast<VarDecl>(p->symbol->decl)->address_taken = true;
+            }
             break;
         default:
             break;
     }
+    u->type->size = u->type->storage_size();
 }
 
 void TypeAnalysis::visit(std::shared_ptr<Binary> b) {
     b->expr1->accept(*this);
     b->expr2->accept(*this);
+    check(b);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Binary> b) {
     switch (b->op->token_type) {
         case TT::PLUS:
         case TT::MINUS:
@@ -70,7 +87,7 @@ void TypeAnalysis::visit(std::shared_ptr<Binary> b) {
         case TT::GE:
         case TT::LT:
         case TT::LE:
-            if (b->expr1->type->str() != "int" || b->expr2->type->str() != "int"){
+            if (!b->expr1->type->is(TT::INT) || !b->expr2->type->is(TT::INT)){
                 throw semantic_exception("Invalid operand type for binary operator '" + getTokenName(b->op->token_type) + "'", b->op);
             }
             b->type = std::make_shared<Type>(*(b->expr1->type));
@@ -81,6 +98,7 @@ void TypeAnalysis::visit(std::shared_ptr<Binary> b) {
                 throw semantic_exception("Invalid operand type for binary operator '" + getTokenName(b->op->token_type) + "'", b->op);
             }
             b->type = std::make_shared<Type>(std::make_shared<Token>(TT::INT));
+            b->type->size = b->type->storage_size();
             break;
         case TT::ASSIGN:
             if (*(b->expr1->type) != *(b->expr2->type)){
@@ -99,26 +117,36 @@ void TypeAnalysis::visit(std::shared_ptr<Binary> b) {
 void TypeAnalysis::visit(std::shared_ptr<Subscript> s) {
     s->array->accept(*this);
     s->index->accept(*this);
+    check(s);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Subscript> s) {
     if (s->array->type->pointerCount == 0 && s->array->type->arraySize.size() == 0){
         throw semantic_exception("Array subscript operator requires an array or pointer type but found '" + s->array->type->str() + "'", s->token);
     }
 
-    if (s->index->type->str() != "int"){
+    if (!s->index->type->is(TT::INT)){
         throw semantic_exception("Array index must be an integer type but found '" + s->index->type->str() + "'", s->token);
     }
 
+    // a[i] of int a[3][4] is an int[4]
     s->type = std::make_shared<Type>(*(s->array->type));
     s->type->pointerCount--;
     s->type->arraySize.clear();
-    for (int i=0;i<s->array->type->arraySize.size()-1;i++){
+    for (int i=1;i<s->array->type->arraySize.size();i++){
         s->type->arraySize.push_back(s->array->type->arraySize[i]);
     }
+    s->type->size = s->type->storage_size();
 
     s->lvalue = s->array->lvalue;
 }
 
 void TypeAnalysis::visit(std::shared_ptr<Member> m) {
     m->structure->accept(*this);
+    check(m);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Member> m) {
     m->lvalue = m->structure->lvalue;
     if (m->structure->type->token->token_type != TT::STRUCT || m->structure->type->pointerCount > 0 || m->structure->type->arraySize.size() > 0){
         throw semantic_exception("Left operand of '.' operator must be a structure but found '" + m->structure->type->str() + "'", m->token);
@@ -136,8 +164,13 @@ void TypeAnalysis::visit(std::shared_ptr<Member> m) {
 
 void TypeAnalysis::visit(std::shared_ptr<TypeCast> t) {
     t->expr1->accept(*this);
-    if ((t->expr1->type->str() == "char" && t->typeCast->str() == "int") || (t->expr1->type->pointerCount > 0 && t->typeCast->pointerCount > 0)){
+    check(t);
+}
+
+void TypeAnalysis::check(std::shared_ptr<TypeCast> t) {
+    if ((t->expr1->type->is(TT::CHAR) && t->typeCast->is(TT::INT)) || (t->expr1->type->pointerCount > 0 && t->typeCast->pointerCount > 0)){
         t->type = std::make_shared<Type>(*t->typeCast);
+        t->type->size = t->type->storage_size();
     }
     else {
         throw semantic_exception("Invalid type cast from '" + t->expr1->type->str() + "' to '" + t->typeCast->str() + "'", t->typeCast->token);
@@ -148,21 +181,43 @@ void TypeAnalysis::visit(std::shared_ptr<Call> call) {
     for (auto a : call->args){
         a->accept(*this);
     }
-    std::shared_ptr<FuncDecl> funcDecl = std::dynamic_pointer_cast<FuncDecl>(call->symbol->decl);
-    if (call->args.size() != funcDecl->args.size()){
+    check(call);
+}
+
+void TypeAnalysis::check(std::shared_ptr<Call> call) {
+    // the callee may only be declared, e.g. a precompiled std function
+    std::shared_ptr<Type> returnType;
+    std::vector<std::shared_ptr<VarDecl>> args;
+    if (auto funcDecl = std::dynamic_pointer_cast<FuncDecl>(call->symbol->decl)){
+        returnType = funcDecl->type;
+        args = funcDecl->args;
+    }
+    else if (auto funProto = std::dynamic_pointer_cast<FunProto>(call->symbol->decl)){
+        returnType = funProto->type;
+        args = funProto->args;
+    }
+    else{
+        throw semantic_exception("'" + call->identifier->value + "' is not a function", call->identifier);
+    }
+
+    if (call->args.size() != args.size()){
         throw semantic_exception("Too few/many arguments in function '" + call->identifier->value + "' call", call->identifier);
     }
 
     for(int i=0;i<call->args.size();i++){
-        if (*(call->args[i]->type) != *(funcDecl->args[i]->type)){
-            throw semantic_exception("Type mismatch in function '" + call->identifier->value + "' call, argument '" + funcDecl->args[i]->name + "' expected type '" + funcDecl->args[i]->type->str() + "' but received '" + call->args[i]->type->str() + "'", call->identifier);
+        if (*(call->args[i]->type) != *(args[i]->type)){
+            throw semantic_exception("Type mismatch in function '" + call->identifier->value + "' call, argument '" + args[i]->name + "' expected type '" + args[i]->type->str() + "' but received '" + call->args[i]->type->str() + "'", call->identifier);
         }
     }
 
-    call->type = std::make_shared<Type>(*(funcDecl->type));
+    call->type = std::make_shared<Type>(*returnType);
 }
 
 void TypeAnalysis::visit(std::shared_ptr<VarDecl> varDecl) {
+    check(varDecl);
+}
+
+void TypeAnalysis::check(std::shared_ptr<VarDecl> varDecl) {
     if (varDecl->type->token->token_type == TT::VOID && varDecl->type->pointerCount == 0){
         throw semantic_exception("Declaration of variable '" + varDecl->name + "' of type void", varDecl->type->token);
     }
@@ -171,7 +226,11 @@ void TypeAnalysis::visit(std::shared_ptr<VarDecl> varDecl) {
 void TypeAnalysis::visit(std::shared_ptr<While> w) {
     w->expr->accept(*this);
     w->stmt->accept(*this);
-    if (w->expr->type->str() != "int"){
+    check(w);
+}
+
+void TypeAnalysis::check(std::shared_ptr<While> w) {
+    if (!w->expr->type->is(TT::INT)){
         throw semantic_exception("While condition must be an integer", w->token);
     }
 }
@@ -182,7 +241,11 @@ void TypeAnalysis::visit(std::shared_ptr<If> i) {
     if (i->stmt2.has_value()){
         i->stmt2->get()->accept(*this);
     }
-    if (i->expr1->type->str() != "int"){
+    check(i);
+}
+
+void TypeAnalysis::check(std::shared_ptr<If> i) {
+    if (!i->expr1->type->is(TT::INT)){
         throw semantic_exception("If condition expression must be an integer", i->token);
     }
 }
@@ -192,9 +255,12 @@ void TypeAnalysis::visit(std::shared_ptr<Return> r) {
     if (r->expr.has_value()){
         r->expr->get()->accept(*this);
     }
+    check(r);
+}
 
+void TypeAnalysis::check(std::shared_ptr<Return> r) {
     std::shared_ptr<FuncDecl> funcDecl = std::dynamic_pointer_cast<FuncDecl>(r->funcDecl->decl);
-    if ((r->expr.has_value() && (*(funcDecl->type) != *(r->expr->get()->type))) || (!r->expr.has_value() && funcDecl->type->str() != "void")){
+    if ((r->expr.has_value() && (*(funcDecl->type) != *(r->expr->get()->type))) || (!r->expr.has_value() && !funcDecl->type->is(TT::VOID))){
         throw semantic_exception("Return type mismatch: expected '" + funcDecl->type->str() + "', but found '" + r->expr->get()->type->str() + "'", r->token);
     }
 
@@ -218,7 +284,9 @@ void TypeAnalysis::visit(std::shared_ptr<FuncDecl> p) {
         a->accept(*this);
     }
 
-    p->block->accept(*this);
+    if (!p->unchanged){
+        p->block->accept(*this);
+    }
 }
 void TypeAnalysis::visit(std::shared_ptr<FunProto> p) {
     for (auto a : p->args){
@@ -227,12 +295,16 @@ void TypeAnalysis::visit(std::shared_ptr<FunProto> p) {
 }
 void TypeAnalysis::visit(std::shared_ptr<StructDecl> p) {
     for (auto d : p->varDecls){
-        if (d->type->name == p->name && d->type->pointerCount == 0){
-            throw semantic_exception("Recursive reference '" + d->name + "' without a pointer in struct '"+ p->name +"'", d->type->token);
-        }
+        check(p, d);
         d->accept(*this);
     }
 }
+
+void TypeAnalysis::check(std::shared_ptr<StructDecl> p, std::shared_ptr<VarDecl> d) {
+    if (d->type->name == p->name && d->type->pointerCount == 0){
+        throw semantic_exception("Recursive reference '" + d->name + "' without a pointer in struct '"+ p->name +"'", d->type->token);
+    }
+}
 void TypeAnalysis::visit(std::shared_ptr<Break> p) {}
 void TypeAnalysis::visit(std::shared_ptr<Continue> p) {}
 void TypeAnalysis::visit(std::shared_ptr<Type> p) {}
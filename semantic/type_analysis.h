@@ -10,7 +10,22 @@
 
 
 class TypeAnalysis : public Visitor<void>{
+public:
+    // checks of a single node whose children already have their types, shared with FusedAnalysis
+    static void check(std::shared_ptr<Primary> primary);
+    static void check(std::shared_ptr<Unary> unary);
+    static void check(std::shared_ptr<Binary> binary);
+    static void check(std::shared_ptr<Subscript> subscript);
+    static void check(std::shared_ptr<Member> member);
+    static void check(std::shared_ptr<TypeCast> t);
+    static void check(std::shared_ptr<Call> call);
+    static void check(std::shared_ptr<VarDecl> varDecl);
+    static void check(std::shared_ptr<While> w);
+    static void check(std::shared_ptr<If> i);
+    static void check(std::shared_ptr<Return> ret);
+    static void check(std::shared_ptr<StructDecl> structDecl, std::shared_ptr<VarDecl> field);
 
+private:
     void visit(std::shared_ptr<FuncDecl> func) override;
     void visit(std::shared_ptr<FunProto> funProto) override;
     void visit(std::shared_ptr<Call> call) override;
@@ -12,7 +12,6 @@ void print_c(char c){
 void print_i(int i){
     emit_asm("sub rsp, 20");
     emit_asm("mov rax, rdi");
-    emit_asm("mov rcx, 10");
     emit_asm("mov byte [rsp], 0");
     emit_asm("test rax, rax");
     emit_asm("jge .not_neg");
@@ -21,11 +20,17 @@ void print_i(int i){
     emit_asm(".not_neg:");
     emit_asm("lea rdi, [rsp+19]");
     emit_asm(".convert:");
-    emit_asm("xor rdx, rdx");
-    emit_asm("div rcx");
-    emit_asm("add dl, '0'");
+    emit_asm("mov rcx, rax");
+    emit_asm("mov rdx, 0xCCCCCCCCCCCCCCCD");
+    emit_asm("mul rdx");
+    emit_asm("shr rdx, 3");
+    emit_asm("mov rax, rdx");
+    emit_asm("lea rdx, [rdx+rdx*4]");
+    emit_asm("add rdx, rdx");
+    emit_asm("sub rcx, rdx");
+    emit_asm("add cl, '0'");
     emit_asm("dec rdi");
-    emit_asm("mov [rdi], dl");
+    emit_asm("mov [rdi], cl");
     emit_asm("test rax, rax");
     emit_asm("jnz .convert");
     emit_asm("cmp byte [rsp], 0");
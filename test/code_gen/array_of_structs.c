@@ -0,0 +1,56 @@
+/*
+3455a9
+*/
+
+#include <print>
+
+struct T {
+    int a;
+    int b;
+    int c;
+};
+
+struct U {
+    int a[5];
+};
+
+struct V {
+    int a[6];
+};
+
+struct W {
+    int a[7];
+};
+
+struct X {
+    char a[40];
+};
+
+int main(){
+    struct T t[4];
+    struct U u[3];
+    struct V v[3];
+    struct W w[3];
+    struct X x[3];
+    int i;
+    i = 0;
+    while (i < 3){
+        t[i].c = i + 1;
+        u[i].a[4] = i + 2;
+        v[i].a[i] = i + 3;
+        w[i].a[6] = i + 4;
+        x[i].a[39] = 'a';
+        i = i + 1;
+    }
+    print_i(t[2].c);
+    print_i(u[2].a[4]);
+    print_i(v[2].a[2]);
+    print_i(w[1].a[6]);
+    print_c(x[2].a[39]);
+
+    int m[3][5];
+    m[2][4] = 9;
+    print_i(m[2][4]);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+25ca979
+*/
+
+#include <print>
+
+int sum(int a[], int n){
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < n){
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+int main(){
+    int a[5];
+    int i;
+    i = 0;
+    while (i < 5){
+        a[i] = i * 10 - 15;
+        i = i + 1;
+    }
+    print_i(sum(a, 5));
+
+    char s[3];
+    s[0] = 'a';
+    s[1] = 'b';
+    s[2] = 'c';
+    print_c(s[2]);
+    print_c(s[0]);
+
+    int m[3][4];
+    i = 0;
+    while (i < 3){
+        int j;
+        j = 0;
+        while (j < 4){
+            m[i][j] = i * 4 + j;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    print_i(m[2][1]);
+    print_i(m[1][3]);
+
+    // small arrays are passed by address like any other
+    int small[2];
+    small[0] = 4;
+    small[1] = 5;
+    print_i(sum(small, 2));
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+-3 -7 3 7
+-4 -5 4 5
+-5 -2 5 2
+-37 0 0 0
+306783378 -1 -483647 1
+2147483647 -2147483647
+0
+*/
+#include <print>
+
+void line(int a, int b, int c, int d){
+    print_i(a);
+    print_c(' ');
+    print_i(b);
+    print_c(' ');
+    print_i(c);
+    print_c(' ');
+    print_i(d);
+    print_c('\n');
+}
+
+// literal divisors against the same divisors in variables, which use idiv
+int mismatches(int n){
+    int d;
+    int wrong;
+    wrong = 0;
+    d = 3;
+    if (n / 3 != n / d){
+        wrong = wrong + 1;
+    }
+    if (n % 3 != n % d){
+        wrong = wrong + 1;
+    }
+    d = 16;
+    if (n / 16 != n / d){
+        wrong = wrong + 1;
+    }
+    if (n % 16 != n % d){
+        wrong = wrong + 1;
+    }
+    d = 641;
+    if (n / 641 != n / d){
+        wrong = wrong + 1;
+    }
+    if (n % 641 != n % d){
+        wrong = wrong + 1;
+    }
+    d = 1000000007;
+    if (n / 1000000007 != n / d){
+        wrong = wrong + 1;
+    }
+    if (n % 1000000007 != n % d){
+        wrong = wrong + 1;
+    }
+    return wrong;
+}
+
+int main(){
+    int x;
+    x = -37;
+    line(x / 10, x % 10, -x / 10, -x % 10);
+    line(x / 8, x % 8, -x / 8, -x % 8);
+    line(x / 7, x % 7, -x / 7, -x % 7);
+    line(x / 1, x % 1, -1 / 2, -1 / 1000);
+
+    x = 2147483647;
+    line(x / 7, -x / 2147483647, -x % 1000000, x % 2);
+    print_i(x);
+    print_c(' ');
+    print_i(-x);
+    print_c('\n');
+
+    int n;
+    int wrong;
+    n = -3000;
+    wrong = 0;
+    while (n <= 3000){
+        wrong = wrong + mismatches(n) + mismatches(n * 715827);
+        n = n + 1;
+    }
+    print_i(wrong);
+    print_c('\n');
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+12 12 5
+6 6
+9 5
+7 4
+3 8
+50 -1
+*/
+#include <print>
+
+struct Point {
+    int x;
+    int y;
+};
+
+void line(int a, int b){
+    print_i(a);
+    print_c(' ');
+    print_i(b);
+    print_c('\n');
+}
+
+// the same field read three times
+int norm(struct Point* p){
+    return (*p).x * (*p).x + (*p).y * (*p).y - (*p).x;
+}
+
+// a store to another field keeps the loaded x, one through another pointer does not
+int fields(struct Point* p, struct Point* q){
+    int a;
+    a = (*p).x;
+    (*p).y = 5;
+    (*q).x = a * 2;
+    return a + (*p).x;
+}
+
+int bump(int* a, int i){
+    a[i] = a[i] + 1;
+    a[i] = a[i] * 2;
+    return a[i] + a[i + 1];
+}
+
+int branches(int c, int x){
+    int y;
+    y = x * 3;
+    if (c == 1){
+        x = x + 1;
+    }
+    else {
+        y = x * 3 + 1;
+    }
+    return x * 3 - y;
+}
+
+int main(){
+    struct Point p;
+    struct Point q;
+    p.x = 3;
+    p.y = 2;
+    q.x = 0;
+    print_i(norm(&p) + 2);
+    print_c(' ');
+    print_i(norm(&p) + 2);
+    print_c(' ');
+    print_i(p.x + p.y + p.x - p.x);
+    print_c('\n');
+
+    // q is p the second time, x changes under the first pointer. Calls are sequenced before the
+    // arguments reading what they store
+    int r;
+    r = fields(&p, &q);
+    line(r, q.x);
+    r = fields(&p, &p);
+    line(r, p.y);
+
+    int a[3];
+    a[0] = 1;
+    a[1] = 3;
+    a[2] = 0;
+    r = bump(a, 0);
+    line(r, a[0]);
+
+    // x is reassigned on one path only
+    line(branches(1, 2), branches(0, 3) + 9);
+
+    // loads in a loop see the stores of the previous iteration
+    int i;
+    int s;
+    a[0] = 1;
+    a[1] = 1;
+    a[2] = 1;
+    i = 0;
+    s = 0;
+    while (i < 5){
+        s = s + a[0] * a[0];
+        a[0] = a[0] + 1;
+        i = i + 1;
+    }
+    line(s + a[0] - 11, a[1] - a[2] - 1);
+    return 0;
+}
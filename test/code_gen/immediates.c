@@ -0,0 +1,69 @@
+/*
+36 -20
+12 x 7 -1
+-2147483647 2147483647 97
+4 5
+*/
+#include <print>
+
+struct Point {
+    int x;
+    char c;
+};
+
+void space(){
+    print_c(' ');
+}
+
+// the last two arguments are pushed
+int many(int a, int b, int c, int d, int e, int f, int g, int h){
+    return a + b + c + d + e + f + g - h;
+}
+
+int minus(){
+    return -20;
+}
+
+// a self call with constant arguments moves them to the parameters
+int count(int n, int steps){
+    if (n == 0){
+        return steps;
+    }
+    return count(n - 1, steps + 1);
+}
+
+// constants are stored and passed without a register of their own
+int main(){
+    int v[4];
+    struct Point s;
+    print_i(many(1, 2, 3, 4, 5, 6, 7, -8));
+    space();
+    print_i(minus());
+    print_c('\n');
+
+    v[1] = 3 * 4;
+    s.c = 'x';
+    s.x = 7;
+    v[2] = -(2 - 3);
+    v[3] = 0 - v[2];
+    print_i(v[1]);
+    space();
+    print_c(s.c);
+    space();
+    print_i(s.x);
+    space();
+    print_i(v[3]);
+    print_c('\n');
+
+    print_i(-2147483647);
+    space();
+    print_i(2147483647);
+    space();
+    print_i((int)'a');
+    print_c('\n');
+
+    print_i(count(4, 0));
+    space();
+    print_i(many(0, 0, 0, 0, 0, 0, 0, -5));
+    return 0;
+}
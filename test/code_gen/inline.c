@@ -0,0 +1,76 @@
+/*
+49
+12
+3
+2
+12
+5
+7
+*/
+#include <print>
+
+struct Point {
+    int x;
+    int y;
+};
+
+int square(int x){
+    return x*x;
+}
+
+int sum_squares(int a, int b){
+    return square(a) + square(b);
+}
+
+int max(int a, int b){
+    if (a > b){
+        return a;
+    }
+    return b;
+}
+
+int count_down(int n){
+    int steps;
+    steps = 0;
+    while (n > 0){
+        n = n - 1;
+        steps = steps + 1;
+    }
+    return steps;
+}
+
+int manhattan(struct Point p){
+    p.x = p.x + p.y;
+    return p.x;
+}
+
+void set(int* p, int v){
+    *p = v;
+}
+
+void line(int n){
+    print_i(n);
+    print_c('\n');
+}
+
+int main(){
+    line(square(square(2)) - sum_squares(1, 2) + square(7) - 11);
+    line(sum_squares(2, 2) + square(2) + max(2, 1) + max(1, 2) - 4);
+    line(max(count_down(3), 1));
+
+    struct Point p;
+    p.x = 1;
+    p.y = 1;
+    line(manhattan(p) + p.x - 1);
+
+    int n;
+    n = 0;
+    set(&n, 12);
+    line(n);
+    line(sum_squares(1, 2));
+
+    int a;
+    a = 3;
+    line(max(a, 4) + count_down(a));
+    return 0;
+}
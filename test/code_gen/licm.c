@@ -0,0 +1,110 @@
+/*
+52
+1 2 4 8
+8 43
+33 33
+*/
+#include <print>
+
+struct Cell {
+    int value;
+    int weight[4];
+};
+
+struct Row {
+    struct Cell cells[4];
+};
+
+void line(int a, int b){
+    print_i(a);
+    print_c(' ');
+    print_i(b);
+    print_c('\n');
+}
+
+int main(){
+    struct Row rows[3];
+    int i;
+    int j;
+    int k;
+    i = 0;
+    while (i < 3){
+        j = 0;
+        while (j < 4){
+            rows[i].cells[j].value = i + j;
+            k = 0;
+            while (k < 4){
+                rows[i].cells[j].weight[k] = k;
+                k = k + 1;
+            }
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+
+    // every base is invariant in the inner loops
+    int total;
+    total = 0;
+    i = 0;
+    while (i < 3){
+        j = 0;
+        while (j < 4){
+            k = 0;
+            while (k < 4){
+                total = total + rows[i].cells[j].value * rows[i].cells[j].weight[k] / 3;
+                k = k + 1;
+            }
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    print_i(total);
+    print_c('\n');
+
+    // a temporary assigned inside the loop body
+    int p;
+    i = 0;
+    while (i < 4){
+        int t;
+        t = 1;
+        p = t;
+        j = 0;
+        while (j < i){
+            p = p * 2;
+            j = j + 1;
+        }
+        print_i(p);
+        if (i < 3){
+            print_c(' ');
+        }
+        i = i + 1;
+    }
+    print_c('\n');
+
+    // continue and break jump around the invariant code
+    int sum;
+    sum = 0;
+    i = 0;
+    while (i < 10){
+        i = i + 1;
+        if (i == 3){
+            continue;
+        }
+        if (i == 8){
+            break;
+        }
+        sum = sum + rows[1].cells[2].value + i;
+    }
+    line(i, sum);
+
+    // the loop never runs, the hoisted code must not change anything
+    int seen;
+    seen = 33;
+    i = 5;
+    while (i < 0){
+        seen = rows[2].cells[3].value;
+        i = i + 1;
+    }
+    line(seen, 33);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+-1179869184 -1179869184
+-2147483648 0 0
+1 -2147483648 -2147483648
+-2147483648 2147483647
+*/
+#include <print>
+
+int total(int* a, int n){
+    int s;
+    int i;
+    s = 0;
+    i = 0;
+    while (i < n){
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+void space(){
+    print_c(' ');
+}
+
+int square(int k){
+    return k * k;
+}
+
+// ints wrap at 32 bits at every optimization level, vectorized or not
+int main(){
+    int a[8];
+    int i;
+    int s;
+    int m;
+    int n;
+    i = 0;
+    while (i < 8){
+        a[i] = 2000000000;
+        i = i + 1;
+    }
+    print_i(total(a, 8));
+    space();
+    s = 0;
+    i = 0;
+    while (i < 8){
+        s = s + 2000000000;
+        i = i + 1;
+    }
+    print_i(s);
+    print_c('\n');
+
+    m = 2147483647;
+    m = m + 1;
+    print_i(m);
+    space();
+    print_i(65536 * 65536);
+    space();
+    print_i(square(65536));
+    print_c('\n');
+
+    m = 2147483647;
+    print_i(m + 1 < m);
+    space();
+    a[0] = m + 1;
+    print_i(a[0]);
+    space();
+    n = 0 - 2147483647 - 1;
+    n = -n;
+    print_i(n);
+    print_c('\n');
+
+    print_i(a[0] * 1);
+    space();
+    print_i(a[0] - 1);
+    return 0;
+}
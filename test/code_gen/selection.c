@@ -0,0 +1,96 @@
+/*
+42 31 -13 27
+15 48 90 -14
+27 7 19 -6
+1 0 1 1 0 1
+5 20 4 48 3 1
+2 6 12 20
+18 -3 0
+*/
+#include <print>
+
+void line(int a, int b, int c, int d){
+    print_i(a);
+    print_c(' ');
+    print_i(b);
+    print_c(' ');
+    print_i(c);
+    print_c(' ');
+    print_i(d);
+}
+
+// sums and scalings fold into one lea
+int combine(int a, int b, int c){
+    return a + b * 4 + c;
+}
+
+// the selector picks each nonterminal per node, with constants folded and on either side
+int main(){
+    int a;
+    int b;
+    int x;
+    a = 5;
+    b = 6;
+    line(combine(a, b, 13), a * 3 + 2 * 8, 1 - (a + 2 * 3 + 4 - 11) - 10, b * 5 - a + 2);
+    print_c('\n');
+    line(a * 3, b * 9 - a + 1 - 2, a * 2 * 9, -(b + 8));
+    print_c('\n');
+    line((b + 3) * 3, 3 * 4 - a, 4 + a * 3, a - 11);
+    print_c('\n');
+
+    print_i(3 < a);
+    print_c(' ');
+    print_i(a < 3);
+    print_c(' ');
+    print_i(5 <= a);
+    print_c(' ');
+    print_i(b >= a + 1);
+    print_c(' ');
+    print_i(6 != b);
+    print_c(' ');
+    print_i(!(a == 6) && 1);
+    print_c('\n');
+
+    // assignments update the variable in place
+    x = a;
+    print_i(x);
+    print_c(' ');
+    x = x * 4;
+    print_i(x);
+    print_c(' ');
+    x = x - 16;
+    print_i(x);
+    print_c(' ');
+    x = 12 * x;
+    print_i(x);
+    print_c(' ');
+    x = a - x + 46;
+    print_i(x);
+    print_c(' ');
+    x = x && 1;
+    print_i(x);
+    print_c('\n');
+
+    // the index adds to the displacement
+    int v[5];
+    int i;
+    i = 0;
+    while (i < 5){
+        v[i] = i * 2;
+        i = i + 1;
+    }
+    i = 1;
+    while (i < 5){
+        v[i] = v[i - 1] + v[i];
+        i = i + 1;
+    }
+    line(v[1], v[2], v[3], v[4]);
+    print_c('\n');
+    i = 2;
+    print_i(v[i + 1] + v[i - 2] + v[1 + i - 1] * 1);
+    print_c(' ');
+    print_i(-(a + b) + 8);
+    print_c(' ');
+    print_i(b * 0);
+    return 0;
+}
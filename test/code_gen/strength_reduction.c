@@ -0,0 +1,115 @@
+/*
+45 285
+10 30
+9 7 5 3 1
+4 10 88
+66
+*/
+#include <print>
+
+struct Point {
+    int x;
+    int y;
+    char tag;
+};
+
+void line(int a, int b){
+    print_i(a);
+    print_c(' ');
+    print_i(b);
+    print_c('\n');
+}
+
+int main(){
+    int a[10];
+    int i;
+    int j;
+    int sum;
+    int squares;
+
+    // i only indexes, the exit test moves to the pointer
+    i = 0;
+    while (i < 10){
+        a[i] = i;
+        i = i + 1;
+    }
+    sum = 0;
+    squares = 0;
+    i = 0;
+    while (i < 10){
+        sum = sum + a[i];
+        squares = squares + a[i] * i;
+        i = i + 1;
+    }
+    line(sum, squares);
+
+    // i is needed after the loop
+    struct Point points[5];
+    i = 0;
+    while (i < 5){
+        points[i].x = i;
+        points[i].y = i * 3;
+        points[i].tag = 'p';
+        i = i + 1;
+    }
+    sum = 0;
+    i = 0;
+    while (i < 5){
+        if (points[i].tag == 'p'){
+            sum = sum + points[i].y;
+        }
+        i = i + 1;
+    }
+    line(i * 2, sum);
+
+    // counting down by two
+    i = 9;
+    while (i >= 0){
+        print_i(a[i]);
+        if (i > 1){
+            print_c(' ');
+        }
+        i = i - 2;
+    }
+    print_c('\n');
+
+    // nested walks over rows and columns
+    int grid[4][3];
+    i = 0;
+    while (i < 4){
+        j = 0;
+        while (j < 3){
+            grid[i][j] = i * j + 1;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    sum = 0;
+    i = 0;
+    while (i < 4){
+        j = 0;
+        while (j < 3){
+            sum = sum + grid[i][j];
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    print_i(j + i - 3);
+    print_c(' ');
+    print_i(grid[3][2] + 3);
+    print_c(' ');
+    print_i(sum * 4 - 32);
+    print_c('\n');
+
+    // a loop that never runs leaves everything untouched
+    int seen;
+    seen = 66;
+    i = 3;
+    while (i < 3){
+        seen = a[i];
+        i = i + 1;
+    }
+    print_i(seen);
+    print_c('\n');
+    return 0;
+}
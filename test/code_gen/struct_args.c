@@ -0,0 +1,150 @@
+/*
+7
+3 4
+5 6 c
+1 2 3 4 5 6
+10 10 90
+11 12 13 14 15
+100 200
+200 100
+*/
+#include <print>
+
+struct One {
+    int a;
+};
+
+struct Two {
+    int a;
+    int b;
+};
+
+struct Three {
+    int a;
+    int b;
+    char c;
+};
+
+struct Six {
+    int v[6];
+};
+
+struct Big {
+    int v[20];
+};
+
+void space(){
+    print_c(' ');
+}
+
+void one(struct One s){
+    print_i(s.a);
+    print_c('\n');
+}
+
+void two(struct Two s){
+    print_i(s.a);
+    space();
+    print_i(s.b);
+    print_c('\n');
+}
+
+void three(struct Three s){
+    print_i(s.a);
+    space();
+    print_i(s.b);
+    space();
+    print_c(s.c);
+    print_c('\n');
+}
+
+void six(struct Six s){
+    int i;
+    i = 0;
+    while (i < 6){
+        if (i > 0){
+            space();
+        }
+        print_i(s.v[i]);
+        i = i + 1;
+    }
+    print_c('\n');
+}
+
+// the callee's copy is its own
+int big(struct Big s){
+    s.v[0] = s.v[0] + s.v[19];
+    return s.v[0];
+}
+
+// a to e take five registers, t needs two and goes on the stack by address, f still gets the sixth
+void crowded(int a, int b, int c, int d, int e, struct Three t, int f){
+    print_i(a);
+    space();
+    print_i(b);
+    space();
+    print_i(t.a);
+    space();
+    print_i(t.b);
+    space();
+    print_i(f);
+    print_c('\n');
+}
+
+struct Two swap(struct Two s){
+    int t;
+    t = s.a;
+    s.a = s.b;
+    s.b = t;
+    print_i(s.a);
+    space();
+    print_i(s.b);
+    print_c('\n');
+    return s;
+}
+
+int main(){
+    struct One o;
+    o.a = 7;
+    one(o);
+
+    struct Two w;
+    w.a = 3;
+    w.b = 4;
+    two(w);
+
+    struct Three t;
+    t.a = 5;
+    t.b = 6;
+    t.c = 'c';
+    three(t);
+
+    struct Six s;
+    int i;
+    i = 0;
+    while (i < 6){
+        s.v[i] = i + 1;
+        i = i + 1;
+    }
+    six(s);
+
+    struct Big b;
+    b.v[0] = 9;
+    b.v[19] = 10;
+    print_i(big(b) - 9);
+    space();
+    print_i(b.v[19]);
+    space();
+    print_i(b.v[0] * 10);
+    print_c('\n');
+
+    t.a = 13;
+    t.b = 14;
+    crowded(11, 12, 0, 0, 0, t, 15);
+
+    w.a = 200;
+    w.b = 100;
+    swap(w);
+    two(w);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+x-123456z-7y42
+*/
+
+#include <print>
+
+struct P {
+    char tag;
+    int v;
+    char name[3];
+};
+
+struct Q {
+    struct P ps[2];
+    int n;
+};
+
+void set(int* p, int v){
+    *p = v;
+}
+
+int main(){
+    struct Q q;
+    q.n = -7;
+    q.ps[1].tag = 'x';
+    q.ps[1].v = -123456;
+    q.ps[1].name[2] = 'z';
+    q.ps[0].tag = 'y';
+
+    struct P p;
+    p = q.ps[1];
+    q.ps[1].v = 1;
+
+    print_c(p.tag);
+    print_i(p.v);
+    print_c(p.name[2]);
+    print_i(q.n);
+    print_c(q.ps[0].tag);
+
+    int x;
+    x = -1;
+    set(&x, 42);
+    print_i(x);
+
+    return 0;
+}
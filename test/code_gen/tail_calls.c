@@ -0,0 +1,78 @@
+/*
+4500000
+1
+0
+6
+21
+3
+*/
+#include <print>
+
+int sum(int n, int acc){
+    if (n == 0){
+        return acc;
+    }
+    return sum(n - 1, acc + n % 10);
+}
+
+int is_odd(int n);
+
+int is_even(int n){
+    if (n == 0){
+        return 1;
+    }
+    return is_odd(n - 1);
+}
+
+int is_odd(int n){
+    if (n == 0){
+        return 0;
+    }
+    return is_even(n - 1);
+}
+
+int gcd(int a, int b){
+    if (b == 0){
+        return a;
+    }
+    return gcd(b, a % b);
+}
+
+int read(int* p){
+    return *p;
+}
+
+// x lives in the frame, so these stay calls
+int depth(int* p, int n){
+    int x;
+    x = *p + 1;
+    if (n == 0){
+        return read(&x);
+    }
+    return depth(&x, n - 1);
+}
+
+int count(int n){
+    if (n == 0){
+        return 0;
+    }
+    return 1 + count(n - 1);
+}
+
+void line(int n){
+    print_i(n);
+    print_c('\n');
+}
+
+int main(){
+    line(sum(1000000, 0));
+    line(is_even(1000000));
+    line(is_odd(1000000));
+    line(gcd(48, 18));
+
+    int start;
+    start = 0;
+    line(depth(&start, 20));
+    line(count(3));
+    return 0;
+}
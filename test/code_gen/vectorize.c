@@ -0,0 +1,114 @@
+/*
+4950 -4950
+0 3 6 9 12 15 18 21 24
+-2 -2 0 4 10 18 28 40 54
+6 6 6 6 6 6 6 6 6
+11 -7 110 1
+0 1 2
+*/
+#include <print>
+
+int total(int* a, int n){
+    int s;
+    int i;
+    s = 0;
+    i = 0;
+    while (i < n){
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+void scale(int* from, int* to, int n, int k){
+    int i;
+    i = 0;
+    while (i < n){
+        to[i] = from[i] * k;
+        i = i + 1;
+    }
+}
+
+void show(int* a, int n){
+    int i;
+    i = 0;
+    while (i < n){
+        print_i(a[i]);
+        if (i < n - 1){
+            print_c(' ');
+        }
+        i = i + 1;
+    }
+    print_c('\n');
+}
+
+int main(){
+    int a[100];
+    int b[100];
+    int sums[9];
+    int i;
+    int n;
+    int s;
+
+    i = 0;
+    while (i < 100){
+        a[i] = i;
+        i = i + 1;
+    }
+
+    // a sum and a difference, 100 is not a multiple of the vector
+    s = 0;
+    i = 0;
+    while (i < 100){
+        s = a[i] + s;
+        i = i + 1;
+    }
+    print_i(total(a, 100));
+    print_c(' ');
+    n = 0;
+    i = 0;
+    while (i < 100){
+        n = n - a[i];
+        i = i + 1;
+    }
+    print_i(n);
+    print_c('\n');
+
+    // a multiply, then element-wise arithmetic on two arrays
+    scale(a, b, 9, 3);
+    show(b, 9);
+    i = 0;
+    while (i <= 8){
+        sums[i] = a[i] + b[i] - b[i] * 2 + a[i] * 3 - -2;
+        sums[i] = -sums[i] + a[i] * a[i];
+        i = i + 1;
+    }
+    show(sums, 9);
+
+    // the arrays overlap by one element, every element is copied from the one before
+    i = 0;
+    while (i < 9){
+        b[i] = i + 6;
+        i = i + 1;
+    }
+    scale(b, &b[1], 8, 1);
+    show(b, 9);
+
+    // in place, and loops shorter than a vector
+    scale(a, a, 100, 11);
+    print_i(a[1]);
+    print_c(' ');
+    print_i(total(a, 0) - 7);
+    print_c(' ');
+    print_i(a[10]);
+    print_c(' ');
+    print_i(total(a, 3) / 33);
+    print_c('\n');
+    scale(a, a, 3, 0);
+    b[0] = 0;
+    b[1] = 1;
+    b[2] = 2;
+    scale(b, a, 3, 1);
+    show(a, 3);
+    return 0;
+}
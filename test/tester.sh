@@ -13,6 +13,8 @@ total_tests=0
 # Function to run tests in a given directory
 run_tests() {
     local test_dir=$1
+    local flags=$2
+    local label=${3:-$test_dir}
     local dir_total_tests=0
     local dir_passed_tests=0
     local failed_tests=()
@@ -30,7 +32,7 @@ run_tests() {
         elif [ "$test_dir" = "lexer" ]; then
             actual_ast=$(../cmake-build-debug/compiler "$test_file" -lexer 2>&1)
         else
-            actual_ast=$(../cmake-build-debug/compiler "$test_file" 2>&1)
+            actual_ast=$(../cmake-build-debug/compiler "$test_file" ${=flags} 2>&1)
             if [ "$test_dir" = "code_gen" ]; then
               nasm -f macho64 ./output.asm -o ./output.o
               ld -o ./output ./output.o -macosx_version_min 10.7 -no_pie
@@ -51,13 +53,13 @@ run_tests() {
     done
 
     # Store results
-    results[$test_dir]="$dir_passed_tests/$dir_total_tests"
+    results[$label]="$dir_passed_tests/$dir_total_tests"
     total_passed=$((total_passed + dir_passed_tests))
     total_tests=$((total_tests + dir_total_tests))
 
     # Display failed tests, if any
     if [ ${#failed_tests[@]} -ne 0 ]; then
-        echo -e "${RED}Failed tests in $test_dir:${NC}"
+        echo -e "${RED}Failed tests in $label:${NC}"
         for test in "${failed_tests[@]}"; do
             echo "  - $test"
         done
@@ -73,6 +75,21 @@ for dir in "${test_dirs[@]}"; do
     run_tests "$dir"
 done
 
+# the single pass analysis has to give the same diagnostics
+fused_dirs=("name_analysis" "type_analysis")
+for dir in "${fused_dirs[@]}"; do
+    run_tests "$dir" "-fused-analysis" "$dir (fused)"
+    test_dirs+=("$dir (fused)")
+done
+
+# inlining and the IR passes must not change what programs print
+run_tests "code_gen" "-O2" "code_gen (-O2)"
+test_dirs+=("code_gen (-O2)")
+run_tests "code_gen" "-O2 -march=x86-64-v2" "code_gen (-O2 -march=x86-64-v2)"
+test_dirs+=("code_gen (-O2 -march=x86-64-v2)")
+run_tests "code_gen" "-fomit-frame-pointer" "code_gen (-fomit-frame-pointer)"
+test_dirs+=("code_gen (-fomit-frame-pointer)")
+
 # After running all tests, print summary table and overall summary
 echo -e "\nSummary Table:"
 echo "--------------------"
@@ -0,0 +1,150 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#include "allocation_counter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// kept apart from the code using new, which would inline free() against the new it sees
+namespace {
+
+std::atomic<int> counting{0};
+thread_local uint64_t allocations = 0;
+thread_local uint64_t allocated_bytes = 0;
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept {
+    if (counting.load(std::memory_order_relaxed)){
+        allocations++;
+        allocated_bytes += size;
+    }
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)){
+        return std::malloc(size);
+    }
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* allocate_or_throw(std::size_t size, std::size_t alignment) {
+    while (true){
+        if (void* p = allocate(size, alignment)){
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler){
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocate_or_null(std::size_t size, std::size_t alignment) noexcept {
+    try{
+        return allocate_or_throw(size, alignment);
+    }
+    catch(...) {
+        return nullptr;
+    }
+}
+
+}
+
+void AllocationCounter::start() {
+    counting.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationCounter::stop() {
+    counting.fetch_sub(1, std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::allocs() {
+    return allocations;
+}
+
+uint64_t AllocationCounter::bytes() {
+    return allocated_bytes;
+}
+
+void* operator new(std::size_t size) {
+    return allocate_or_throw(size, 0);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate_or_throw(size, 0);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, std::size_t(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, std::size_t(alignment));
+}
+
+// malloc and aligned_alloc memory are both released by free
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,26 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#ifndef COMPILER_ALLOCATION_COUNTER_H
+#define COMPILER_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+/*
+ * Allocations made by the calling thread, for -time-report and -time-trace
+ *
+ * The global operator new and delete are replaced in allocation_counter.cpp, every form of them.
+ * Allocations are only counted between start and stop, which nest, so a compile without a profiler
+ * pays one relaxed load per allocation. Counters are per thread so counting never contends
+ */
+class AllocationCounter {
+public:
+    static void start();
+    static void stop();
+
+    static uint64_t allocs();
+    static uint64_t bytes();
+};
+
+#endif //COMPILER_ALLOCATION_COUNTER_H
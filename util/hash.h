@@ -0,0 +1,52 @@
+//
+// Created by Ryan Senoune on 2025-03-04.
+//
+
+#ifndef COMPILER_HASH_H
+#define COMPILER_HASH_H
+
+#include <cstdint>
+#include <string>
+
+/*
+ * 64 bit FNV-1a
+ * Stable across platforms and standard libraries, unlike std::hash, so it can key files on disk
+ */
+class Hash {
+public:
+    uint64_t value = 14695981039346656037ull;
+
+    Hash& add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++){
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+        return *this;
+    }
+
+    // length prefixed so ("ab","c") and ("a","bc") differ
+    Hash& add(const std::string& s) {
+        add(uint64_t(s.size()));
+        return add(s.data(), s.size());
+    }
+
+    Hash& add(uint64_t v) {
+        return add(&v, sizeof(v));
+    }
+
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string s(16, '0');
+        for (int i = 0; i < 16; i++){
+            s[15 - i] = digits[(value >> (i * 4)) & 0xf];
+        }
+        return s;
+    }
+
+    static uint64_t of(const std::string& s) {
+        return Hash().add(s).value;
+    }
+};
+
+#endif //COMPILER_HASH_H
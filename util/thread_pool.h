@@ -0,0 +1,168 @@
+//
+// Created by Ryan Senoune on 2025-03-02.
+//
+
+#ifndef COMPILER_THREAD_POOL_H
+#define COMPILER_THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished tasks submitted under it, ThreadPool::wait blocks on it
+class TaskGroup {
+public:
+    std::atomic<int> pending{0};
+};
+
+/*
+ * Work stealing pool
+ * Every worker owns a deque: it pushes and pops its own tasks at the back and steals from
+ * the front of the others. Threads waiting on a TaskGroup run queued tasks instead of blocking,
+ * so a task may submit nested work (translation unit -> functions) and wait on it safely.
+ * With 0 or 1 workers tasks run inline on the calling thread, so -j1 never spawns a thread
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int workers) {
+        if (workers <= 1){
+            return;
+        }
+        for (int i = 0; i < workers; i++){
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 0; i < workers; i++){
+            threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        task_ready.notify_all();
+        for (auto& t : threads){
+            t.join();
+        }
+    }
+
+    void submit(TaskGroup& group, std::function<void()> task) {
+        if (threads.empty()){
+            task();
+            return;
+        }
+
+        group.pending++;
+        auto wrapped = [this, &group, task = std::move(task)] {
+            task();
+            if (--group.pending == 0){
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                task_ready.notify_all();
+            }
+        };
+
+        // workers keep their own tasks local, outside threads spread them round robin
+        int index = current_pool == this ? current_worker : int(next_queue++ % queues.size());
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(wrapped));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued++;
+        }
+        task_ready.notify_one();
+    }
+
+    // blocks until every task of the group has finished, running queued tasks meanwhile
+    void wait(TaskGroup& group) {
+        while (group.pending > 0){
+            if (run_one(current_pool == this ? current_worker : 0)){
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            task_ready.wait_for(lock, std::chrono::milliseconds(1), [&] { return queued > 0 || group.pending == 0; });
+        }
+    }
+
+private:
+    struct Queue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<unsigned> next_queue{0};
+
+    std::mutex sleep_mutex;
+    std::condition_variable task_ready;
+    int queued = 0;
+    bool stopping = false;
+
+    static inline thread_local ThreadPool* current_pool = nullptr;
+    static inline thread_local int current_worker = 0;
+
+    bool take(int index, bool own, std::function<void()>& task) {
+        Queue& q = *queues[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()){
+            return false;
+        }
+        if (own){
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else{
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return true;
+    }
+
+    bool run_one(int self) {
+        std::function<void()> task;
+        bool found = take(self, true, task);
+
+        for (int i = 1; !found && i < int(queues.size()); i++){
+            found = take((self + i) % int(queues.size()), false, task);
+        }
+
+        if (!found){
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued--;
+        }
+        task();
+        return true;
+    }
+
+    void work(int index) {
+        current_pool = this;
+        current_worker = index;
+
+        while (true){
+            if (run_one(index)){
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            task_ready.wait_for(lock, std::chrono::milliseconds(10), [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0){
+                return;
+            }
+        }
+    }
+};
+
+#endif //COMPILER_THREAD_POOL_H
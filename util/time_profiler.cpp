@@ -0,0 +1,163 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#include "time_profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#include "allocation_counter.h"
+
+static int64_t thread_cpu_us() {
+    timespec t{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return int64_t(t.tv_sec) * 1000000 + t.tv_nsec / 1000;
+}
+
+static int64_t peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+TimeProfiler::TimeProfiler() {
+    AllocationCounter::start();
+}
+
+TimeProfiler::~TimeProfiler() {
+    AllocationCounter::stop();
+}
+
+TimeProfiler::Scope::Scope(TimeProfiler* profiler, std::string name, std::string detail) : profiler(profiler) {
+    if (!profiler){
+        return;
+    }
+    event.name = std::move(name);
+    event.detail = std::move(detail);
+    event.cpu_us = thread_cpu_us();
+    event.rss_kb = peak_rss_kb();
+    event.allocs = AllocationCounter::allocs();
+    event.alloc_bytes = AllocationCounter::bytes();
+    start = std::chrono::steady_clock::now();
+}
+
+TimeProfiler::Scope::~Scope() {
+    if (!profiler){
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    event.start_us = std::chrono::duration_cast<std::chrono::microseconds>(start - profiler->epoch).count();
+    event.wall_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    event.cpu_us = thread_cpu_us() - event.cpu_us;
+    event.rss_kb = peak_rss_kb() - event.rss_kb;
+    event.allocs = AllocationCounter::allocs() - event.allocs;
+    event.alloc_bytes = AllocationCounter::bytes() - event.alloc_bytes;
+    profiler->record(std::move(event));
+}
+
+void TimeProfiler::record(Event event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto thread = threads.emplace(std::this_thread::get_id(), int(threads.size()));
+    event.thread = thread.first->second;
+    events.push_back(std::move(event));
+}
+
+void TimeProfiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    epoch = std::chrono::steady_clock::now();
+}
+
+/*
+ * Phases nest (Compile contains Parse, Generate contains the function phases), so the rows
+ * don't sum to the total. Per-function rows add up over the pool, their wall time can
+ * exceed the elapsed time with -j
+ */
+std::string TimeProfiler::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    struct Row {
+        std::string name;
+        int64_t first = 0;
+        int calls = 0;
+        int64_t wall_us = 0;
+        int64_t cpu_us = 0;
+        int64_t rss_kb = 0;
+        uint64_t allocs = 0;
+        uint64_t alloc_bytes = 0;
+    };
+
+    std::vector<Row> rows;
+    std::unordered_map<std::string, size_t> index;
+    int64_t elapsed = 0;
+    for (auto& e : events){
+        auto it = index.emplace(e.name, rows.size());
+        if (it.second){
+            rows.push_back({e.name, e.start_us});
+        }
+        Row& row = rows[it.first->second];
+        row.first = std::min(row.first, e.start_us);
+        row.calls++;
+        row.wall_us += e.wall_us;
+        row.cpu_us += e.cpu_us;
+        row.rss_kb += e.rss_kb;
+        row.allocs += e.allocs;
+        row.alloc_bytes += e.alloc_bytes;
+        elapsed = std::max(elapsed, e.start_us + e.wall_us);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.first < b.first; });
+
+    std::string out;
+    char line[160];
+    snprintf(line, sizeof(line), "===--- Time report: %.3f ms on %zu threads ---===\n", elapsed / 1000.0, threads.size());
+    out += line;
+    snprintf(line, sizeof(line), "%-16s %7s %11s %11s %9s %10s %10s\n", "phase", "calls", "wall ms", "cpu ms", "rss +kB", "allocs", "alloc kB");
+    out += line;
+    for (auto& r : rows){
+        snprintf(line, sizeof(line), "%-16s %7d %11.3f %11.3f %9lld %10llu %10llu\n", r.name.c_str(), r.calls, r.wall_us / 1000.0,
+                 r.cpu_us / 1000.0, (long long) r.rss_kb, (unsigned long long) r.allocs, (unsigned long long) (r.alloc_bytes / 1024));
+        out += line;
+    }
+    return out;
+}
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s){
+        if (c == '"' || c == '\\'){
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char) c < 0x20){
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            out += escape;
+        }
+        else{
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// loads in chrome://tracing and Perfetto, every worker is its own track
+std::string TimeProfiler::trace() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string out = "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); i++){
+        const Event& e = events[i];
+        out += "{\"name\":" + json_string(e.name) + ",\"cat\":\"compiler\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(e.thread) +
+               ",\"ts\":" + std::to_string(e.start_us) + ",\"dur\":" + std::to_string(e.wall_us) +
+               ",\"args\":{\"detail\":" + json_string(e.detail) + ",\"cpu_us\":" + std::to_string(e.cpu_us) +
+               ",\"allocs\":" + std::to_string(e.allocs) + "}}";
+        out += i + 1 < events.size() ? ",\n" : "\n";
+    }
+    out += "],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
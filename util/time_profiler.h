@@ -0,0 +1,76 @@
+//
+// Created by Ryan Senoune on 2025-03-11.
+//
+
+#ifndef COMPILER_TIME_PROFILER_H
+#define COMPILER_TIME_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Records how long each compiler phase takes, for -time-report and -time-trace
+ *
+ * A phase is timed by a Scope on the stack. Wall time, thread CPU time and allocations are
+ * measured on the thread that runs the scope, so per-function phases on the pool add up over
+ * all workers. Peak RSS is process wide, a phase gets the growth of the peak while it ran.
+ * Every call site takes a nullable profiler so a normal compile pays one branch per phase, and
+ * allocations are only counted while a profiler exists.
+ */
+class TimeProfiler {
+public:
+    struct Event {
+        std::string name;
+        // input file or function name
+        std::string detail;
+        int thread;
+        int64_t start_us;
+        int64_t wall_us;
+        int64_t cpu_us;
+        int64_t rss_kb;
+        uint64_t allocs;
+        uint64_t alloc_bytes;
+    };
+
+    class Scope {
+    public:
+        Scope(TimeProfiler* profiler, std::string name, std::string detail = "");
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TimeProfiler* profiler;
+        Event event;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    TimeProfiler();
+    ~TimeProfiler();
+
+    TimeProfiler(const TimeProfiler&) = delete;
+    TimeProfiler& operator=(const TimeProfiler&) = delete;
+
+    // one line per phase name, in order of first use
+    std::string report() const;
+    // Chrome trace event format, one complete event per scope
+    std::string trace() const;
+    // watch mode reports every recompile on its own
+    void clear();
+
+private:
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::unordered_map<std::thread::id, int> threads;
+
+    void record(Event event);
+};
+
+#endif //COMPILER_TIME_PROFILER_H
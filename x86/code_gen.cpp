@@ -3,6 +3,7 @@
 //
 
 #include "code_gen.h"
+#include <cstdlib>
 
 
 void CodeGen::generate(std::shared_ptr<BasicInstruction> i) {
@@ -20,11 +21,21 @@ void CodeGen::generate(std::shared_ptr<BasicInstruction> i) {
         return;
     }
 
-    if (i->registers.size() == 2) {
-        emit(i->opcode + " " + get_reg(i->registers[0]) + ", " + get_reg(i->registers[1]));
+    // the immediate comes last, as in pshufd xmm0, xmm1, 0 or the three operand AVX forms
+    if (i->registers.size() >= 2) {
+        std::string operands = get_reg(i->registers[0]);
+        for (size_t k = 1; k < i->registers.size(); k++){
+            operands += ", " + get_reg(i->registers[k]);
+        }
+        emit(i->opcode + " " + operands + (i->value.size() ? ", " + i->value : ""));
         return;
     }
 
+    // push imm32
+    if (i->value.size()){
+        emit(i->opcode + " " + i->value);
+        return;
+    }
     emit(i->opcode);
 }
 void CodeGen::generate(std::shared_ptr<GlobalVariable> i){
@@ -56,25 +67,38 @@ void CodeGen::generate(std::shared_ptr<Instruction> i) {
 }
 
 void CodeGen::generate(){
+    generate_globals();
+    generate_header();
+    generate_text();
+    generate_entry();
+}
+
+void CodeGen::generate_globals(){
 
-    if (std::dynamic_pointer_cast<GlobalVariable>(curr()) ){
+    if (index < instructions.size() && std::dynamic_pointer_cast<GlobalVariable>(curr()) ){
         emit("section .bss");
 
-        while (std::dynamic_pointer_cast<GlobalVariable>(curr())){
+        while (index < instructions.size() && std::dynamic_pointer_cast<GlobalVariable>(curr())){
             generate(curr());
             index++;
         }
         emit("");
     }
+}
 
+void CodeGen::generate_header(){
     emit("section .text");
     emit("global start");
+}
 
+void CodeGen::generate_text(){
     while (index < instructions.size()) {
         generate(curr());
         index++;
     }
+}
 
+void CodeGen::generate_entry(){
     emit("");
     emit("start:");
     emit("call main");
@@ -88,10 +112,26 @@ std::string CodeGen::get_reg(std::shared_ptr<Register> r){
 
     std::string location;
 
+    if (auto a = std::dynamic_pointer_cast<Address>(r)){
+        location = a->base->name;
+        if (a->index){
+            location += " + " + a->index->name + (a->scale > 1 ? "*" + std::to_string(a->scale) : "");
+        }
+        if (a->disp){
+            location += (a->disp > 0 ? " + " : " - ") + std::to_string(std::abs(a->disp));
+        }
+        return get_size_specifier(a->size) + " [" + location + "]";
+    }
+
     if (r->isVirtual){
         return get_size_specifier(r->size) + " " + reg_alloc[r->name];
     }
 
+    // the address is always a full register, the size is the width of the access
+    if (r->isMemoryOperand){
+        return get_size_specifier(r->size) + " [" + r->name + "]";
+    }
+
     switch (r->size) {
         case 4:
             location = r->name_d;
@@ -107,9 +147,5 @@ std::string CodeGen::get_reg(std::shared_ptr<Register> r){
             break;
     }
 
-    if (r->isMemoryOperand){
-        location = "[" + location + "]";
-    }
-
     return location;
 }
\ No newline at end of file
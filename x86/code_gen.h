@@ -11,17 +11,17 @@
 class CodeGen {
 public:
 
-    std::ofstream file;
+    std::ostream& file;
     std::vector<std::shared_ptr<Instruction>> instructions;
     int index = 0;
     std::unordered_map<std::string, std::string> reg_alloc;
 
 
 
-    CodeGen(const std::string &filename,
+    CodeGen(std::ostream& file,
             std::vector<std::shared_ptr<Instruction>> &&instructions,
             std::unordered_map<std::string, std::string> &&reg_alloc) :
-            file(filename), instructions(instructions), reg_alloc(reg_alloc) {}
+            file(file), instructions(instructions), reg_alloc(reg_alloc) {}
 
     std::shared_ptr<Instruction> curr() {
         return instructions[index];
@@ -31,7 +31,12 @@ public:
         file << s << std::endl;
     }
 
+    // whole program: globals, text section header, every instruction and the entry point
     void generate();
+    void generate_globals();
+    void generate_header();
+    void generate_text();
+    void generate_entry();
     void generate(std::shared_ptr<Instruction> i);
     void generate(std::shared_ptr<BasicInstruction> i);
     void generate(std::shared_ptr<GlobalVariable> i);
@@ -44,7 +49,9 @@ public:
             {1, "byte"},
             {2, "word"},
             {4, "dword"},
-            {8, "qword"}
+            {8, "qword"},
+            {16, "oword"},
+            {32, "yword"}
     };
 
     std::string get_size_specifier(int size){